@@ -0,0 +1,78 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "ThreadPool.h"
+
+//Decodes image files on the thread pool and streams them to GL through pixel buffer objects.
+//request() hands out the final texture name immediately, filled with a 1x1 grey placeholder,
+//and update() replaces its contents once the decoded image has been uploaded.
+class AsyncTextureLoader
+{
+public:
+	AsyncTextureLoader(ThreadPool& threadPool, size_t uploadBudgetPerFrame = 16u * 1024u * 1024u);
+	~AsyncTextureLoader();
+
+	//Queues "path" for decoding. GL thread only.
+	unsigned int request(const std::string& path, bool gamma = false, GLint wrapMode = GL_REPEAT);
+	//Uploads decoded images until the per frame byte budget is spent, at least one image per call so large
+	//images cannot starve. Returns how many textures became resident. GL thread only.
+	unsigned int update();
+	//Blocks until every requested texture is resident, ignoring the budget. GL thread only.
+	void finish();
+	//Drops the pending upload of "textureId", used before the texture is deleted. GL thread only.
+	void cancel(unsigned int textureId);
+	//Deletes the staging pixel buffers. Call before the GL context is destroyed, the destructor does not touch GL.
+	//Safe to call more than once. GL thread only.
+	void release();
+
+	//True while "textureId" still shows the placeholder.
+	bool isPending(unsigned int textureId) const;
+	//Requested textures that are not resident yet.
+	unsigned int getPendingCount() const;
+	unsigned long long getUploadedBytes() const;
+
+private:
+	struct DecodedImage
+	{
+		unsigned int textureId;
+		unsigned long long requestId;
+		std::string path;
+		unsigned char* pixels;
+		int width, height, channels;
+		bool gamma;
+		GLint wrapMode;
+	};
+
+	//Decode jobs may still run when the loader is destroyed, so their output queue is reference counted.
+	struct SharedState
+	{
+		std::mutex mutex;
+		std::vector<DecodedImage> completed;
+
+		~SharedState();
+	};
+
+	void collectCompleted();
+	void upload(const DecodedImage& image);
+
+	ThreadPool& pool;
+	std::shared_ptr<SharedState> state;
+	//Decoded images taken from the shared queue that did not fit into the budget yet.
+	std::vector<DecodedImage> ready;
+	//Texture id to its latest request. Results of cancelled or superseded requests are dropped.
+	std::unordered_map<unsigned int, unsigned long long> pendingRequests;
+	unsigned long long nextRequestId;
+
+	//Uploads alternate between two PBOs so a new copy does not wait for the previous transfer.
+	unsigned int pixelBuffers[2];
+	unsigned int nextPixelBuffer;
+	size_t uploadBudget;
+	unsigned long long uploadedBytes;
+};
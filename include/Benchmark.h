@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+#include "PhysicsWorld.h"
+#include "SceneConfig.h"
+#include "ThreadPool.h"
+
+//Steps the world "stepCount" times at pPhysicsStepSize without any window or GL context,
+//then prints wall time, steps per second and per step latency percentiles.
+void runHeadlessBenchmark(PhysicsWorld& world, unsigned int stepCount);
+//Steps a fresh "stackSize" x "stackSize" scene for 1..maxWorkerCount workers, once on ThreadPool
+//through PoolCpuDispatcher and once on PxDefaultCpuDispatcher, and prints a steps per second table.
+//With "profiler" every run's PhysX zone histograms are appended to "profilePath".
+void runDispatcherScalingBenchmark(unsigned int stepCount, unsigned int stackSize, unsigned int maxWorkerCount, bool pinToCores,
+	PhysXProfiler* profiler = nullptr, const std::string& profilePath = std::string());
+//Culls "bodyCount" random boxes "iterationCount" times with FrustumCuller's SSE and scalar paths,
+//checks that both agree and prints time per pass and bodies per second.
+void runCullingBenchmark(unsigned int bodyCount, unsigned int iterationCount);
+//Writes a text scene with "bodyCount" box lines, then times text parsing, binary save and load,
+//PhysicsWorld::buildScene() and the first step on "world", which must be initialised and empty.
+void runSceneLoadBenchmark(PhysicsWorld& world, unsigned int bodyCount);
+//Builds a grid of "bodyCount" identical boxes three times: exclusive shapes with integrated mass, exclusive shapes
+//with closed form mass and shared registry shapes. Prints build time, first step time, PhysX heap bytes per body
+//and the number of shapes for each.
+void runSpawnBenchmark(unsigned int bodyCount, unsigned int workerCount);
+//Steps eight "stackSize" x "stackSize" walls once alone and once under a projectile barrage, for "baseline" and for
+//variants that change one broadphase, solver, friction or scene flag option each. Prints steps per second and p99
+//step time per configuration and names the fastest one for each scene.
+void runSceneConfigBenchmark(unsigned int stepCount, unsigned int stackSize, unsigned int workerCount, const SceneConfig& baseline);
+//Casts "rayCount" rays from "origin" spread uniformly over a cone of "coneAngle" degrees around "front", "iterationCount"
+//times through SceneQueryService on "pool" and as many times serially on the calling thread. Prints time per batch,
+//rays per second and hit count for both. "scene" must not be simulating.
+void runSceneQueryBenchmark(physx::PxScene* scene, ThreadPool& pool, const physx::PxVec3& origin, const physx::PxVec3& front,
+	unsigned int rayCount = 10000u, unsigned int iterationCount = 20u, float coneAngle = 30.f);
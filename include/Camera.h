@@ -16,6 +16,8 @@ public:
 	void update();
 
 	void setCameraPosition(glm::vec3 position);
+	//Used by input replay, mouse look angles are left unchanged.
+	void setCameraFront(glm::vec3 front);
 	void setCameraSpeed(float value = 0.002f);
 	void setSensivity(float value = 0.1f);
 	void setFirstTouch(bool value = true);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "StreamBuffer.h"
+
+//std140 uniform block shared by every shader that declares "Camera" at binding point 0.
+//View and projection are uploaded once per frame instead of once per shader and draw.
+class CameraBuffer
+{
+public:
+	static constexpr unsigned int bindingPoint = 0u;
+
+	CameraBuffer();
+
+	//Writes the block into this frame's stream region and binds that range. Falls back to the own buffer when the
+	//region is full.
+	void update(const glm::mat4& view, const glm::mat4& projection, StreamBuffer& stream);
+
+private:
+	unsigned int UBO;
+};
\ No newline at end of file
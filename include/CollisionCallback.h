@@ -1,23 +1,78 @@
 #pragma once
 
-#include <iostream>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
 #include "PxPhysicsAPI.h"
 
-// Current collision callback class is just for learning purposes and cannot process more than two actors.
+#include "SpscRing.h"
+
+enum class ContactEventType : uint8_t
+{
+	Contact,
+	TriggerEnter,
+	TriggerExit
+};
+
+//Compact record of one contact point or trigger transition. Trigger events carry no contact data.
+struct ContactEvent
+{
+	physx::PxActor* actor0;
+	physx::PxActor* actor1;
+	physx::PxVec3 position;
+	physx::PxVec3 impulse;
+	physx::PxVec3 normal;
+	ContactEventType type;
+};
+
+//Actor that fell asleep or woke up during a fetched step. Only actors with PxActorFlag::eSEND_SLEEP_NOTIFIES are reported.
+struct SleepTransition
+{
+	physx::PxActor* actor;
+	bool sleeping;
+};
+
+//Writes contacts and trigger transitions into a preallocated ring buffer, no allocation or I/O happens
+//inside PhysX callbacks. Consumer drains events with popEvent() after fetchResults().
 class CollisionCallback : public physx::PxSimulationEventCallback
 {
 public:
+	static constexpr physx::PxU32 maxContactPointsPerPair = 64u;
+	static constexpr size_t eventCapacity = 16384u;
+
+	CollisionCallback();
+
 	//Trigger callback function that called when rigid dynamics enters trigger zone.
 	void onTrigger(physx::PxTriggerPair* pairs, physx::PxU32 count);
 	//Collision callback function that called when 2 rigid dynamics collide with each other.
 	void onContact(const physx::PxContactPairHeader& pairHeader, const physx::PxContactPair* pairs, physx::PxU32 nbPairs);
 
+	//Sleep state changes, called from fetchResults(). A lost wake would freeze a moving body on screen, so unlike
+	//contacts they are kept in a vector that only grows, its capacity is reused once transitions are taken.
+	void onWake(physx::PxActor** actors, physx::PxU32 count);
+	void onSleep(physx::PxActor** actors, physx::PxU32 count);
+
 	//PxSimulationEventCallback overrides. Basically do nothing on events.
 	void onConstraintBreak(physx::PxConstraintInfo* constraints, physx::PxU32 count) {};
-	void onWake(physx::PxActor** actors, physx::PxU32 count) {};
-	void onSleep(physx::PxActor** actors, physx::PxU32 count) {};
 	void onAdvance(const physx::PxRigidBody* const* bodyBuffer, const physx::PxTransform* poseBuffer, const physx::PxU32 count) {};
-};
 
+	//Consumer side, returns false when no event is pending.
+	bool popEvent(ContactEvent& event);
+	//Events lost because the ring was full when they were produced.
+	unsigned long long getDroppedEventCount() const;
+	//Contact points beyond maxContactPointsPerPair that were not extracted.
+	unsigned long long getTruncatedContactCount() const;
+	//Moves pending sleep transitions into "transitions" in the order they happened. Must be called after every
+	//fetch by whoever tracks sleep state, or discarded the same way when nobody does.
+	void takeSleepTransitions(std::vector<SleepTransition>& transitions);
+
+private:
+	void pushEvent(const ContactEvent& event);
+
+	SpscRing<ContactEvent> events;
+	std::vector<SleepTransition> sleepTransitions;
+	physx::PxContactPairPoint contactScratch[maxContactPointsPerPair];
+	std::atomic<unsigned long long> droppedEventCount;
+	std::atomic<unsigned long long> truncatedContactCount;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "PhysicsWorld.h"
+
+//Turns variable frame times into a whole number of fixed physics steps.
+//Leftover time is carried to the next frame and exposed as an interpolation factor for rendering.
+class FixedStepScheduler
+{
+public:
+	FixedStepScheduler(double fixedStepSize = pPhysicsStepSize, unsigned int maxSubstepCount = 5u);
+
+	//Accumulates frame time and returns how many steps must be simulated this frame.
+	//At most maxSubsteps are returned, time beyond that is dropped to avoid a spiral of death.
+	unsigned int advance(double frameTime);
+	//Fraction of a step left in the accumulator, in range [0, 1).
+	float getAlpha() const;
+	//Total number of steps handed out so far.
+	unsigned long long getStepIndex() const;
+	//Number of times frame time was dropped because maxSubsteps was exceeded.
+	unsigned long long getDroppedFrameCount() const;
+
+	double getStepSize() const;
+	void setMaxSubsteps(unsigned int value);
+
+private:
+	double stepSize;
+	double accumulator;
+	unsigned int maxSubsteps;
+	unsigned long long stepIndex;
+	unsigned long long droppedFrameCount;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+//Hierarchical CPU zones plus GL_TIME_ELAPSED GPU zones of the render thread. Zones are aggregated per frame,
+//so a zone entered several times in one frame (e.g. catch up steps) counts as the sum of its calls.
+//GPU queries are read back gpuLatency frames later and only if their result is already available, the
+//profiler never waits on the GPU. Timer queries cannot nest, a GPU zone opened inside another one is CPU only.
+//Must be constructed with a current GL context and only used from the thread owning it.
+class FrameProfiler
+{
+public:
+	static constexpr unsigned int gpuLatency = 4u;
+	static constexpr unsigned int maxGpuZonesPerFrame = 32u;
+
+	//Statistics and trace events cover the last "historyLength" frames.
+	FrameProfiler(unsigned int historyLength = 300u);
+
+	void beginFrame();
+	void endFrame();
+	//"name" must outlive the profiler, zones are keyed by the pointer. Use string literals.
+	void beginZone(const char* name, bool gpu = false);
+	void endZone();
+
+	//Prints min, average and 99th percentile per frame of every zone in milliseconds.
+	void printReport() const;
+	//Writes the recorded frames as Chrome trace_event JSON, viewable in chrome://tracing or Perfetto.
+	bool writeChromeTrace(const std::string& path) const;
+
+	//GPU samples whose result was not ready when their query slot had to be reused.
+	unsigned long long getDroppedGpuSampleCount() const;
+	//Deletes the timer queries. Call before the GL context is destroyed, reports and traces still work afterwards
+	//but the profiler must not be used for further frames. Safe to call more than once.
+	void release();
+
+private:
+	struct ZoneEvent
+	{
+		unsigned int zone;
+		unsigned int depth;
+		//Milliseconds since the profiler was created.
+		double start;
+		double duration;
+	};
+
+	struct FrameRecord
+	{
+		unsigned long long frameIndex;
+		std::vector<ZoneEvent> cpuEvents;
+		std::vector<ZoneEvent> gpuEvents;
+	};
+
+	struct PendingQuery
+	{
+		unsigned int zone;
+		unsigned int depth;
+		double cpuStart;
+	};
+
+	struct QuerySlot
+	{
+		unsigned long long frameIndex;
+		unsigned int queries[maxGpuZonesPerFrame];
+		PendingQuery pending[maxGpuZonesPerFrame];
+		unsigned int pendingCount;
+	};
+
+	struct ZoneStatistics
+	{
+		const char* name;
+		//Per frame totals indexed by frame % historyLength, negative when the zone did not run.
+		std::vector<float> cpuTotals;
+		std::vector<float> gpuTotals;
+	};
+
+	struct OpenZone
+	{
+		unsigned int zone;
+		double start;
+		bool gpu;
+	};
+
+	double now() const;
+	unsigned int getZoneIndex(const char* name);
+	void collectGpuResults(QuerySlot& slot);
+
+	std::chrono::high_resolution_clock::time_point epoch;
+	unsigned int history;
+	unsigned long long frameIndex;
+	double frameStart;
+
+	std::vector<FrameRecord> frames;
+	std::vector<ZoneStatistics> zones;
+	std::unordered_map<const char*, unsigned int> zoneIndices;
+	std::vector<OpenZone> openZones;
+	QuerySlot querySlots[gpuLatency];
+	bool gpuZoneOpen;
+	unsigned long long droppedGpuSampleCount;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+#include "PxPhysicsAPI.h"
+
+#include <glm/glm.hpp>
+
+//Axis aligned boxes in structure of arrays layout. Arrays are padded to a multiple of 4 with empty boxes,
+//so SIMD code can always load 4 lanes without reading past the end.
+class BoundsSoA
+{
+public:
+	BoundsSoA();
+
+	void push(const physx::PxBounds3& bounds);
+	void set(unsigned int index, const physx::PxBounds3& bounds);
+	physx::PxBounds3 get(unsigned int index) const;
+	//Moves the last box into "index" and shrinks by one, same order as TransformCache slots.
+	void swapRemove(unsigned int index);
+	void clear();
+
+	unsigned int size() const;
+	//Component arrays: 0..2 minimum x, y, z and 3..5 maximum x, y, z.
+	const float* component(unsigned int axis) const;
+
+private:
+	void pad();
+	static float padValue(unsigned int axis);
+
+	std::vector<float> components[6];
+	unsigned int count;
+};
+
+//Tests boxes against the six planes of a view projection matrix.
+class FrustumCuller
+{
+public:
+	FrustumCuller();
+
+	//Extracts normalized clip planes of an OpenGL style (-w..w) view projection matrix.
+	void setViewProjection(const glm::mat4& viewProjection);
+	//Appends indices of boxes that intersect the frustum to "visible", 4 boxes per iteration with SSE.
+	//Returns the number of visible boxes and adds to the frame counters.
+	unsigned int cull(const BoundsSoA& bounds, std::vector<unsigned int>& visible);
+	//One box at a time reference implementation, used by the culling benchmark.
+	unsigned int cullScalar(const BoundsSoA& bounds, std::vector<unsigned int>& visible) const;
+
+	//Frame counters of cull() calls since the last resetCounters().
+	void resetCounters();
+	unsigned int getVisibleCount() const;
+	unsigned int getTotalCount() const;
+
+private:
+	//a, b, c, d of each plane, inside when a*x + b*y + c*z + d >= 0.
+	float planes[6][4];
+	unsigned int visibleCount;
+	unsigned int totalCount;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "Mesh.h"
+
+//Record layout read by glMultiDrawElementsIndirect().
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+//Location of one mesh inside the arena.
+struct ArenaRange
+{
+	unsigned int firstIndex;
+	unsigned int indexCount;
+	unsigned int baseVertex;
+};
+
+//Vertices and indices of many meshes sub-allocated from one vertex buffer and one 32 bit index buffer, drawn
+//through a single VAO. Every mesh is packed with the arena's vertex layout, attributes a mesh lacks are zero.
+//Buffers grow by copying on the GPU, ranges handed out before stay valid.
+//Must be constructed with a current GL context and only used from the thread owning it.
+class GeometryArena
+{
+public:
+	GeometryArena(unsigned int attributes, unsigned int vertexCapacity = 65536u, unsigned int indexCapacity = 262144u);
+
+	//Appends a mesh. Indices are relative to the mesh, ArenaRange::baseVertex offsets them.
+	ArenaRange add(const Vertex* vertexData, unsigned int vertexCount, const unsigned int* indexData, unsigned int indexCount);
+	//Binds the shared VAO, its element buffer is the arena's index buffer.
+	void bind() const;
+	//Deletes the VAO and both buffers. Call before the GL context is destroyed, the destructor does not touch GL.
+	//Safe to call more than once, ranges handed out before must not be drawn afterwards.
+	void release();
+
+	unsigned int getAttributes() const;
+	unsigned int getVertexCount() const;
+	unsigned int getIndexCount() const;
+
+private:
+	static void growBuffer(unsigned int& buffer, size_t usedBytes, size_t newBytes);
+
+	VertexLayout layout;
+	unsigned int VAO;
+	unsigned int VBO;
+	unsigned int EBO;
+	unsigned int vertexCount;
+	unsigned int indexCount;
+	unsigned int vertexCapacity;
+	unsigned int indexCapacity;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "MappedFile.h"
+
+enum InputFlag : uint32_t
+{
+	INPUT_PHYSICS_STARTED = 1u,
+	INPUT_FIRE = 2u
+};
+
+//Everything a frame feeds into the simulation. "stepIndex" is FixedStepScheduler::getStepIndex() after
+//the frame advanced, so a replay runs exactly the recorded number of steps between camera updates.
+struct InputFrame
+{
+	uint64_t stepIndex;
+	uint32_t flags;
+	//Interpolation factor the frame was rendered with.
+	float alpha;
+	float position[3];
+	float front[3];
+};
+
+//Appends frames to a binary log: a fixed header followed by raw InputFrame records.
+class InputRecorder
+{
+public:
+	InputRecorder();
+	~InputRecorder();
+
+	//"sceneSource" names the scene the session started from, replays warn when it differs.
+	bool open(const std::string& path, const std::string& sceneSource);
+	void record(const InputFrame& frame);
+	void close();
+
+	bool isOpen() const;
+	uint64_t getFrameCount() const;
+
+private:
+	std::ofstream stream;
+	uint64_t frameCount;
+};
+
+//Read only view of a recorded log. Frame count follows from the file size, so logs of crashed sessions still replay.
+class InputReplay
+{
+public:
+	InputReplay();
+
+	bool open(const std::string& path);
+
+	uint64_t getFrameCount() const;
+	const InputFrame& getFrame(uint64_t index) const;
+	std::string getSceneSource() const;
+	double getStepSize() const;
+
+private:
+	MappedFile file;
+	const InputFrame* frames;
+	uint64_t frameCount;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+//Memory mapping of a whole file. Pages are loaded by the OS on first access,
+//so opening a large file costs nothing until its contents are read.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	//Returns false when the file does not exist, is empty or cannot be mapped.
+	//With "copyOnWrite" the mapping is writable, modified pages become private copies and the file is never changed.
+	bool open(const std::string& path, bool copyOnWrite = false);
+	void close();
+
+	const unsigned char* data() const;
+	//Null unless the file was opened with "copyOnWrite".
+	unsigned char* mutableData();
+	size_t size() const;
+	bool isOpen() const;
+
+private:
+	unsigned char* mappedData;
+	size_t mappedSize;
+	bool writable;
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fileDescriptor;
+#endif
+};
@@ -4,9 +4,12 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 
 #include <Shader.h>
 
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 using namespace std;
@@ -30,6 +33,79 @@ struct Vertex {
     float m_Weights[MAX_BONE_INFLUENCE];
 };
 
+// vertex attributes a mesh can upload. A mesh uploads only what the shader reads and the asset provides,
+// so attribute locations stay fixed but the buffer layout is built per mesh.
+enum VertexAttribute : unsigned int {
+    VERTEX_POSITION = 1u << 0,  // location 0, 3 floats
+    VERTEX_NORMAL = 1u << 1,    // location 1, snorm 10-10-10-2
+    VERTEX_TEXCOORDS = 1u << 2, // location 2, 2 half floats
+    VERTEX_TANGENT = 1u << 3,   // location 3, snorm 10-10-10-2, w holds the bitangent sign
+    VERTEX_BONES = 1u << 4,     // locations 5 and 6, 4 ints and 4 floats
+    VERTEX_ALL = VERTEX_POSITION | VERTEX_NORMAL | VERTEX_TEXCOORDS | VERTEX_TANGENT | VERTEX_BONES
+};
+
+// interleaved vertex buffer layout of a set of attributes, shared by meshes and the geometry arena
+struct VertexLayout {
+    unsigned int attributes;
+    size_t normalOffset;
+    size_t texCoordsOffset;
+    size_t tangentOffset;
+    size_t boneIdsOffset;
+    size_t weightsOffset;
+    unsigned int stride;
+
+    // layout of the enabled attributes only, positions are always present
+    static VertexLayout build(unsigned int attributes)
+    {
+        VertexLayout layout;
+        layout.attributes = attributes | VERTEX_POSITION;
+        layout.normalOffset = sizeof(glm::vec3);
+        layout.texCoordsOffset = layout.normalOffset + (layout.has(VERTEX_NORMAL) ? sizeof(uint32_t) : 0);
+        layout.tangentOffset = layout.texCoordsOffset + (layout.has(VERTEX_TEXCOORDS) ? sizeof(uint32_t) : 0);
+        layout.boneIdsOffset = layout.tangentOffset + (layout.has(VERTEX_TANGENT) ? sizeof(uint32_t) : 0);
+        layout.weightsOffset = layout.boneIdsOffset + (layout.has(VERTEX_BONES) ? sizeof(int) * MAX_BONE_INFLUENCE : 0);
+        layout.stride = (unsigned int)(layout.weightsOffset + (layout.has(VERTEX_BONES) ? sizeof(float) * MAX_BONE_INFLUENCE : 0));
+        return layout;
+    }
+
+    bool has(unsigned int attribute) const
+    {
+        return (attributes & attribute) != 0;
+    }
+
+    // packs "vertexCount" vertices into "out", which must hold vertexCount * stride bytes
+    void pack(const Vertex* vertexData, size_t vertexCount, unsigned char* out) const
+    {
+        for (size_t i = 0; i < vertexCount; i++, out += stride)
+        {
+            const Vertex& vertex = vertexData[i];
+            std::memcpy(out, &vertex.Position, sizeof(glm::vec3));
+            if (has(VERTEX_NORMAL))
+            {
+                uint32_t normal = glm::packSnorm3x10_1x2(glm::vec4(vertex.Normal, 0.0f));
+                std::memcpy(out + normalOffset, &normal, sizeof(uint32_t));
+            }
+            if (has(VERTEX_TEXCOORDS))
+            {
+                uint32_t texCoords = glm::packHalf2x16(vertex.TexCoords);
+                std::memcpy(out + texCoordsOffset, &texCoords, sizeof(uint32_t));
+            }
+            if (has(VERTEX_TANGENT))
+            {
+                // bitangent is rebuilt in the shader as cross(normal, tangent) * w
+                float sign = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Bitangent) < 0.0f ? -1.0f : 1.0f;
+                uint32_t tangent = glm::packSnorm3x10_1x2(glm::vec4(vertex.Tangent, sign));
+                std::memcpy(out + tangentOffset, &tangent, sizeof(uint32_t));
+            }
+            if (has(VERTEX_BONES))
+            {
+                std::memcpy(out + boneIdsOffset, vertex.m_BoneIDs, sizeof(vertex.m_BoneIDs));
+                std::memcpy(out + weightsOffset, vertex.m_Weights, sizeof(vertex.m_Weights));
+            }
+        }
+    }
+};
+
 struct Texture {
     unsigned int id;
     string type;
@@ -44,49 +120,81 @@ public:
     vector<Texture>      textures;
     unsigned int VAO;
 
-    // constructor
-    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
+    // constructor, "attributes" selects the uploaded vertex layout. CPU side vertices and indices are released
+    // once uploaded unless "retainCpuData" is set, call releaseCpuData() when they are no longer needed.
+    // without "upload" no GL objects are created and the CPU data is always kept, e.g. for a geometry arena.
+    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures, unsigned int attributes = VERTEX_ALL, bool retainCpuData = false, bool upload = true)
+        : VAO(0), VBO(0), EBO(0)
     {
-        this->vertices = vertices;
-        this->indices = indices;
-        this->textures = textures;
+        this->vertices = std::move(vertices);
+        this->indices = std::move(indices);
+        this->textures = std::move(textures);
+
+        if (!upload)
+        {
+            setupSamplerNames();
+            this->indexCount = this->indices.size();
+            this->indexType = GL_UNSIGNED_INT;
+            this->attributes = attributes | VERTEX_POSITION;
+            this->vertexStride = VertexLayout::build(attributes).stride;
+            return;
+        }
 
         // now that we have all the required data, set the vertex buffers and its attribute pointers.
-        setupMesh();
+        setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size(), attributes);
+        if (!retainCpuData)
+            releaseCpuData();
+    }
+
+    // constructor for data that is not owned by the mesh (e.g. a mapped mesh cache), it is uploaded to GL without a CPU side copy
+    Mesh(const Vertex* vertexData, unsigned int vertexCount, const unsigned int* indexData, unsigned int indexCount, vector<Texture> textures, unsigned int attributes = VERTEX_ALL)
+    {
+        this->textures = std::move(textures);
+
+        setupMesh(vertexData, vertexCount, indexData, indexCount, attributes);
+    }
+
+    // frees CPU side vertices and indices, GL buffers keep the uploaded copy
+    void releaseCpuData()
+    {
+        vector<Vertex>().swap(vertices);
+        vector<unsigned int>().swap(indices);
+    }
+
+    // attributes present in the vertex buffer
+    unsigned int getAttributes() const
+    {
+        return attributes;
+    }
+
+    // bytes per vertex in the vertex buffer
+    unsigned int getVertexStride() const
+    {
+        return vertexStride;
     }
 
     // render the mesh
     void Draw(Shader& shader)
     {
-        // bind appropriate textures
-        unsigned int diffuseNr = 1;
-        unsigned int specularNr = 1;
-        unsigned int normalNr = 1;
-        unsigned int heightNr = 1;
+        DrawInstanced(shader, 1);
+    }
+
+    // render "instanceCount" copies of the mesh, per instance transforms come from the bound instance buffer
+    void DrawInstanced(Shader& shader, unsigned int instanceCount)
+    {
+        // bind appropriate textures, sampler names were resolved once in setupMesh()
         for (unsigned int i = 0; i < textures.size(); i++)
         {
             glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
-            // retrieve texture number (the N in diffuse_textureN)
-            string number;
-            string name = textures[i].type;
-            if (name == "texture_diffuse")
-                number = std::to_string(diffuseNr++);
-            else if (name == "texture_specular")
-                number = std::to_string(specularNr++); // transfer unsigned int to string
-            else if (name == "texture_normal")
-                number = std::to_string(normalNr++); // transfer unsigned int to string
-            else if (name == "texture_height")
-                number = std::to_string(heightNr++); // transfer unsigned int to string
-
             // now set the sampler to the correct texture unit
-            glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()), i);
+            shader.setInt(samplerNames[i], i);
             // and finally bind the texture
             glBindTexture(GL_TEXTURE_2D, textures[i].id);
         }
 
         // draw mesh
         glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(indexCount), indexType, 0, instanceCount);
         glBindVertexArray(0);
 
         // always good practice to set everything back to defaults once configured.
@@ -96,10 +204,62 @@ public:
 private:
     // render data 
     unsigned int VBO, EBO;
+    // number of indices uploaded to EBO, CPU side indices may be empty
+    size_t indexCount;
+    // GL_UNSIGNED_SHORT when every index fits into 16 bits, GL_UNSIGNED_INT otherwise
+    GLenum indexType;
+    unsigned int attributes;
+    unsigned int vertexStride;
+    // sampler uniform name of every texture (e.g. texture_diffuse1), built once instead of every draw
+    vector<string> samplerNames;
+
+    // retrieve texture number (the N in diffuse_textureN) of every texture
+    void setupSamplerNames()
+    {
+        unsigned int diffuseNr = 1;
+        unsigned int specularNr = 1;
+        unsigned int normalNr = 1;
+        unsigned int heightNr = 1;
+        samplerNames.clear();
+        for (unsigned int i = 0; i < textures.size(); i++)
+        {
+            string number;
+            string name = textures[i].type;
+            if (name == "texture_diffuse")
+                number = std::to_string(diffuseNr++);
+            else if (name == "texture_specular")
+                number = std::to_string(specularNr++); // transfer unsigned int to string
+            else if (name == "texture_normal")
+                number = std::to_string(normalNr++); // transfer unsigned int to string
+            else if (name == "texture_height")
+                number = std::to_string(heightNr++); // transfer unsigned int to string
+            samplerNames.push_back(name + number);
+        }
+    }
 
     // initializes all the buffer objects/arrays
-    void setupMesh()
+    void setupMesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount, unsigned int attributes)
     {
+        setupSamplerNames();
+        this->indexCount = indexCount;
+
+        // interleaved layout of the enabled attributes only
+        const VertexLayout layout = VertexLayout::build(attributes);
+        this->attributes = layout.attributes;
+        vertexStride = layout.stride;
+        const bool hasNormal = layout.has(VERTEX_NORMAL);
+        const bool hasTexCoords = layout.has(VERTEX_TEXCOORDS);
+        const bool hasTangent = layout.has(VERTEX_TANGENT);
+        const bool hasBones = layout.has(VERTEX_BONES);
+        const size_t normalOffset = layout.normalOffset;
+        const size_t texCoordsOffset = layout.texCoordsOffset;
+        const size_t tangentOffset = layout.tangentOffset;
+        const size_t boneIdsOffset = layout.boneIdsOffset;
+        const size_t weightsOffset = layout.weightsOffset;
+
+        vector<unsigned char> packed(vertexCount * vertexStride);
+        layout.pack(vertexData, vertexCount, packed.data());
+
         // create buffers/arrays
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
@@ -108,37 +268,53 @@ private:
         glBindVertexArray(VAO);
         // load data into vertex buffers
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        // A great thing about structs is that their memory layout is sequential for all its items.
-        // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
-        // again translates to 3/2 floats which translates to a byte array.
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.data(), GL_STATIC_DRAW);
 
+        // 16 bit indices halve index bandwidth whenever the vertex count allows it
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        if (vertexCount <= 65536)
+        {
+            vector<unsigned short> shortIndices(indexData, indexData + indexCount);
+            indexType = GL_UNSIGNED_SHORT;
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned short), shortIndices.data(), GL_STATIC_DRAW);
+        }
+        else
+        {
+            indexType = GL_UNSIGNED_INT;
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indexData, GL_STATIC_DRAW);
+        }
 
-        // set the vertex attribute pointers
+        // set the vertex attribute pointers, locations missing from the layout keep their default value
         // vertex Positions
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexStride, (void*)0);
         // vertex normals
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+        if (hasNormal)
+        {
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, vertexStride, (void*)normalOffset);
+        }
         // vertex texture coords
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-        // vertex tangent
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
-        // vertex bitangent
-        glEnableVertexAttribArray(4);
-        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
-        // ids
-        glEnableVertexAttribArray(5);
-        glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, m_BoneIDs));
-
-        // weights
-        glEnableVertexAttribArray(6);
-        glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_Weights));
+        if (hasTexCoords)
+        {
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, vertexStride, (void*)texCoordsOffset);
+        }
+        // vertex tangent and bitangent sign
+        if (hasTangent)
+        {
+            glEnableVertexAttribArray(3);
+            glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, vertexStride, (void*)tangentOffset);
+        }
+        if (hasBones)
+        {
+            // ids
+            glEnableVertexAttribArray(5);
+            glVertexAttribIPointer(5, 4, GL_INT, vertexStride, (void*)boneIdsOffset);
+            // weights
+            glEnableVertexAttribArray(6);
+            glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, vertexStride, (void*)weightsOffset);
+        }
         glBindVertexArray(0);
     }
 };
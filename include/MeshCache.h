@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Mesh.h"
+#include "MappedFile.h"
+
+//Binary cache of imported meshes, written next to the source asset as "<asset>.meshcache".
+//It stores final Vertex and index arrays plus material texture paths, so a valid cache skips Assimp entirely.
+//A cache is valid only for the same format version, Vertex layout, source path, source size, source mtime and import flags.
+constexpr unsigned int pMeshCacheVersion = 2u;
+
+//View into a mapped cache file. Vertex and index pointers stay valid while the owning MeshCacheReader is open.
+struct CachedMesh
+{
+	const Vertex* vertices;
+	unsigned int vertexCount;
+	const unsigned int* indices;
+	unsigned int indexCount;
+	//VertexAttribute flags the source asset provides.
+	unsigned int attributes;
+	//Texture type and path only, ids are resolved by the caller.
+	std::vector<Texture> textures;
+};
+
+class MeshCacheReader
+{
+public:
+	//Maps the cache of "sourcePath". Returns false when it is missing, stale or malformed.
+	bool open(const std::string& sourcePath, unsigned int importFlags);
+	void close();
+
+	const std::vector<CachedMesh>& getMeshes() const;
+
+private:
+	MappedFile file;
+	std::vector<CachedMesh> meshes;
+};
+
+std::string getMeshCachePath(const std::string& sourcePath);
+//Writes meshes imported from "sourcePath". Meshes must still hold their CPU side vertices and indices.
+//"assetAttributes" holds the VertexAttribute flags the asset provides for each mesh.
+bool writeMeshCache(const std::string& sourcePath, unsigned int importFlags, const std::vector<Mesh>& meshes, const std::vector<unsigned int>& assetAttributes);
@@ -10,6 +10,12 @@
 #include <assimp/postprocess.h>
 
 #include <Mesh.h>
+#include <MeshCache.h>
+#include <AsyncTextureLoader.h>
+#include <TextureCache.h>
+#include <GeometryArena.h>
+#include <TextureArray.h>
+#include <StreamBuffer.h>
 #include <Shader.h>
 
 #include <string>
@@ -25,13 +31,19 @@ class Model
 {
 public:
     // model data 
-    std::vector<Texture> textures_loaded;	// stores all the textures loaded so far, optimization to make sure textures aren't loaded more than once.
+    std::vector<TextureHandle> textures_loaded;	// references into the global TextureCache, released when the model is destroyed.
     std::vector<Mesh>    meshes;
     std::string directory;
     bool gammaCorrection;
 
     // constructor, expects a filepath to a 3D model.
-    Model(std::string const& path, bool gamma = false) : gammaCorrection(gamma)
+    // with a texture loader, textures are decoded in the background and show a placeholder until they are uploaded.
+    // "attributes" are the vertex attributes the drawing shader reads, the default matches main.vert.
+    // with a geometry arena the meshes are appended to it instead of getting their own buffers, "meshes" stays empty
+    // and the model is drawn with DrawIndirect(). Diffuse textures then come from "textureArray" when given.
+    Model(std::string const& path, bool gamma = false, AsyncTextureLoader* loader = nullptr, unsigned int attributes = VERTEX_POSITION | VERTEX_NORMAL | VERTEX_TEXCOORDS,
+        GeometryArena* geometryArena = nullptr, TextureArray* textureArray = nullptr)
+        : gammaCorrection(gamma), textureLoader(loader), vertexAttributes(attributes), arena(geometryArena), arenaTextures(textureArray)
     {
         loadModel(path);
     }
@@ -43,24 +55,126 @@ public:
             meshes[i].Draw(shader);
     }
 
+    // draws "instanceCount" copies of every mesh, one instanced draw call per mesh
+    void DrawInstanced(Shader& shader, unsigned int instanceCount)
+    {
+        for (unsigned int i = 0; i < meshes.size(); i++)
+            meshes[i].DrawInstanced(shader, instanceCount);
+    }
+
+    // draws "instanceCount" copies of an arena model with one glMultiDrawElementsIndirect call, whatever the mesh count.
+    // the commands are written into "stream", the texture array layer of each mesh is passed as its base instance.
+    void DrawIndirect(unsigned int instanceCount, StreamBuffer& stream)
+    {
+        if (drawCommands.empty() || instanceCount == 0)
+            return;
+
+        arena->bind();
+        if (arenaTextures)
+            arenaTextures->bind();
+
+        StreamAllocation allocation = stream.allocate(drawCommands.size() * sizeof(DrawElementsIndirectCommand), sizeof(GLuint));
+        if (allocation.data)
+        {
+            DrawElementsIndirectCommand* commands = static_cast<DrawElementsIndirectCommand*>(allocation.data);
+            for (size_t i = 0; i < drawCommands.size(); i++)
+            {
+                commands[i] = drawCommands[i];
+                commands[i].instanceCount = instanceCount;
+            }
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, stream.getBuffer());
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)allocation.offset, (GLsizei)drawCommands.size(), 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+        else
+        {
+            // the stream region is full this frame, submit the same draws one by one
+            for (const DrawElementsIndirectCommand& command : drawCommands)
+                glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, command.count, GL_UNSIGNED_INT, (void*)(command.firstIndex * sizeof(GLuint)),
+                    instanceCount, command.baseVertex, command.baseInstance);
+        }
+        glBindVertexArray(0);
+    }
+
+    // number of meshes drawn by DrawIndirect()
+    unsigned int getDrawCommandCount() const
+    {
+        return (unsigned int)drawCommands.size();
+    }
+
 private:
+    AsyncTextureLoader* textureLoader;
+    unsigned int vertexAttributes;
+    GeometryArena* arena;
+    TextureArray* arenaTextures;
+    // one command per mesh in the arena, instanceCount is filled in when drawing
+    std::vector<DrawElementsIndirectCommand> drawCommands;
+    // vertex attributes each imported mesh provides, only filled while importing with ASSIMP
+    std::vector<unsigned int> assetAttributes;
+
     // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
     void loadModel(std::string const& path)
     {
+        const unsigned int importFlags = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace;
+        // retrieve the directory path of the filepath
+        directory = path.substr(0, path.find_last_of('/'));
+
+        // a valid binary cache next to the asset is mapped and uploaded straight to GL, ASSIMP is not touched
+        MeshCacheReader cache;
+        if (cache.open(path, importFlags))
+        {
+            for (const CachedMesh& cached : cache.getMeshes())
+            {
+                if (arena)
+                    addToArena(cached.vertices, cached.vertexCount, cached.indices, cached.indexCount, loadCachedTextures(cached.textures));
+                else
+                    meshes.push_back(Mesh(cached.vertices, cached.vertexCount, cached.indices, cached.indexCount, loadCachedTextures(cached.textures), vertexAttributes & cached.attributes));
+            }
+            return;
+        }
+
         // read file via ASSIMP
         Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+        const aiScene* scene = importer.ReadFile(path, importFlags);
         // check for errors
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
         {
             std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
             return;
         }
-        // retrieve the directory path of the filepath
-        directory = path.substr(0, path.find_last_of('/'));
 
         // process ASSIMP's root node recursively
         processNode(scene->mRootNode, scene);
+
+        // store the result so the next launch can skip the import, then drop the CPU copies kept for it
+        writeMeshCache(path, importFlags, meshes, assetAttributes);
+        for (Mesh& mesh : meshes)
+            mesh.releaseCpuData();
+        assetAttributes.clear();
+
+        // arena models only needed the meshes for the cache, their geometry already lives in the arena
+        if (arena)
+            meshes.clear();
+    }
+
+    // appends one mesh to the arena and records its draw command
+    void addToArena(const Vertex* vertexData, unsigned int vertexCount, const unsigned int* indexData, unsigned int indexCount, const std::vector<Texture>& meshTextures)
+    {
+        ArenaRange range = arena->add(vertexData, vertexCount, indexData, indexCount);
+
+        unsigned int layer = 0;
+        if (arenaTextures)
+        {
+            for (const Texture& texture : meshTextures)
+            {
+                if (texture.type == "texture_diffuse")
+                {
+                    layer = arenaTextures->addLayer(texture.id);
+                    break;
+                }
+            }
+        }
+        drawCommands.push_back({ range.indexCount, 0, range.firstIndex, (GLint)range.baseVertex, layer });
     }
 
     // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
@@ -92,7 +206,7 @@ private:
         // walk through each of the mesh's vertices
         for (unsigned int i = 0; i < mesh->mNumVertices; i++)
         {
-            Vertex vertex;
+            Vertex vertex = {}; // zero initialised so unused fields are deterministic in the mesh cache
             glm::vec3 vector; // we declare a placeholder vector since assimp uses its own vector class that doesn't directly convert to glm's vec3 class so we transfer the data to this placeholder glm::vec3 first.
             // positions
             vector.x = mesh->mVertices[i].x;
@@ -162,8 +276,20 @@ private:
         std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
         textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
 
-        // return a mesh object created from the extracted mesh data
-        return Mesh(vertices, indices, textures);
+        // upload only attributes that both the shader reads and the asset provides (tangents are generated only with texture coordinates)
+        unsigned int available = VERTEX_POSITION;
+        if (mesh->HasNormals())
+            available |= VERTEX_NORMAL;
+        if (mesh->mTextureCoords[0])
+            available |= VERTEX_TEXCOORDS | VERTEX_TANGENT;
+        assetAttributes.push_back(available);
+
+        // arena models skip the per mesh buffers, the CPU data is copied into the arena right away
+        if (arena)
+            addToArena(vertices.data(), (unsigned int)vertices.size(), indices.data(), (unsigned int)indices.size(), textures);
+
+        // return a mesh object created from the extracted mesh data, CPU data is kept until the mesh cache is written
+        return Mesh(std::move(vertices), std::move(indices), std::move(textures), vertexAttributes & available, true, arena == nullptr);
     }
 
     // checks all material textures of a given type and loads the textures if they're not loaded yet.
@@ -175,26 +301,35 @@ private:
         {
             aiString str;
             mat->GetTexture(type, i, &str);
-            // check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
-            bool skip = false;
-            for (unsigned int j = 0; j < textures_loaded.size(); j++)
-            {
-                if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-                {
-                    textures.push_back(textures_loaded[j]);
-                    skip = true; // a texture with the same filepath has already been loaded, continue to next one. (optimization)
-                    break;
-                }
-            }
-            if (!skip)
-            {   // if texture hasn't been loaded already, load it
-                Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
-                texture.type = typeName;
-                texture.path = str.C_Str();
-                textures.push_back(texture);
-                textures_loaded.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
-            }
+            // textures shared with other meshes or models are found in the global cache instead of being loaded again
+            Texture texture;
+            texture.id = loadTexture(str.C_Str());
+            texture.type = typeName;
+            texture.path = str.C_Str();
+            textures.push_back(texture);
+        }
+        return textures;
+    }
+
+    // loads a texture relative to the model directory through the global texture cache,
+    // asynchronously when a texture loader was given. The model keeps one reference per use.
+    unsigned int loadTexture(const char* path)
+    {
+        unsigned int id = TextureCache::instance().acquire(directory + '/' + path, gammaCorrection, GL_REPEAT, textureLoader);
+        if (id != 0)
+            textures_loaded.push_back(TextureHandle(id));
+        return id;
+    }
+
+    // loads textures listed in a mesh cache the same way loadMaterialTextures does.
+    std::vector<Texture> loadCachedTextures(const std::vector<Texture>& cachedTextures)
+    {
+        std::vector<Texture> textures;
+        for (const Texture& cached : cachedTextures)
+        {
+            Texture texture = cached;
+            texture.id = loadTexture(cached.path.c_str());
+            textures.push_back(texture);
         }
         return textures;
     }
@@ -203,40 +338,14 @@ private:
 
 unsigned int TextureFromFile(const char* path, const std::string& directory, bool gamma)
 {
+    // the caller owns one reference of the cached texture
     std::string filename = std::string(path);
     filename = directory + '/' + filename;
 
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
+    unsigned int textureID = TextureCache::instance().acquire(filename, gamma, GL_REPEAT);
+    if (textureID == 0)
         std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
 
     return textureID;
 }
+
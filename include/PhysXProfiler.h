@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PxPhysicsAPI.h"
+
+#include "SpscRing.h"
+
+//Receives PhysX's internal profile zones (broadphase, narrowphase, solver, integration...) and aggregates them per step.
+//Every thread that reports zones gets its own SpscRing on first use, so zoneStart()/zoneEnd() never lock.
+//Register with PxSetProfilerCallback() and call endStep() after every fetched step, PhysicsWorld does that when
+//the profiler is attached with setPhysXProfiler(). Zones are only emitted by PhysX builds with profiling support.
+class PhysXProfiler : public physx::PxProfilerCallback
+{
+public:
+	//Events one thread can report between two endStep() calls, later ones are dropped and counted.
+	explicit PhysXProfiler(size_t eventsPerThread = 4096u);
+
+	PhysXProfiler(const PhysXProfiler&) = delete;
+	PhysXProfiler& operator=(const PhysXProfiler&) = delete;
+
+	void* zoneStart(const char* eventName, bool detached, uint64_t contextId) override;
+	void zoneEnd(void* profilerData, const char* eventName, bool detached, uint64_t contextId) override;
+
+	//Drains every thread buffer and records the step's per zone totals. Call from one thread while no step is running.
+	void endStep();
+	//Forgets recorded steps, e.g. between benchmark runs. Thread buffers are kept.
+	void reset();
+	//Writes per zone statistics and log2 histograms of per step zone time. With "append" a section is added
+	//to an existing file, so several runs can be compared side by side.
+	bool writeHistograms(const std::string& path, const std::string& label, bool append) const;
+
+	unsigned long long getStepCount() const;
+	unsigned long long getDroppedEventCount() const;
+
+private:
+	struct ZoneEvent
+	{
+		const char* name;
+		uint64_t start;
+		uint64_t end;
+	};
+
+	struct ThreadBuffer
+	{
+		explicit ThreadBuffer(size_t capacity);
+
+		SpscRing<ZoneEvent> events;
+		//Written by the producer only, read by endStep().
+		std::atomic<unsigned long long> droppedCount;
+	};
+
+	struct ZoneHistory
+	{
+		//Microseconds per step, summed over threads.
+		std::vector<float> totals;
+		//Microseconds from the first start to the last end in a step.
+		std::vector<float> spans;
+		unsigned long long callCount;
+	};
+
+	ThreadBuffer* getThreadBuffer();
+
+	const unsigned long long id;
+	const size_t capacity;
+	double ticksToMicroseconds;
+
+	//Guards registration only, producers never take it once their buffer exists.
+	std::mutex buffersMutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+	//PhysX zone names are string literals, so the pointer identifies the zone.
+	std::unordered_map<const char*, ZoneHistory> zones;
+	unsigned long long stepCount;
+	unsigned long long droppedEventCount;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vector>
+
+#include "PxPhysicsAPI.h"
+
+#include "CollisionCallback.h"
+#include "SceneDescription.h"
+#include "MappedFile.h"
+#include "PhysXProfiler.h"
+#include "SceneConfig.h"
+#include "ShapeRegistry.h"
+#include "TrackingAllocator.h"
+
+//Fixed simulation step. PhysX is sensitive to non constant time steps so every path (windowed or headless) uses this.
+constexpr double pPhysicsStepSize = 1.0 / 60.0;
+
+//Owns every PhysX object used by the application. It has no dependency on GLFW or OpenGL,
+//so the same world can be stepped inside the render loop or from a headless benchmark.
+class PhysicsWorld
+{
+public:
+	PhysicsWorld();
+	~PhysicsWorld();
+
+	//Creates foundation, physics, a PxDefaultCpuDispatcher with "workerCount" threads, scene and the common material.
+	//"enhancedDeterminism" sets PxSceneFlag::eENABLE_ENHANCED_DETERMINISM, needed to replay recorded sessions exactly.
+	void initialise(physx::PxU32 workerCount = 15u, bool enhancedDeterminism = false);
+	//Same as above but simulation tasks run on "dispatcher", which is not owned and must outlive release().
+	void initialise(physx::PxCpuDispatcher* dispatcher, bool enhancedDeterminism = false);
+	//Broadphase, solver, friction and scene flags of the scene created by the next initialise().
+	void setSceneConfig(const SceneConfig& config);
+	const SceneConfig& getSceneConfig() const;
+	//Creates ground plane, box stack, kinematic camera sphere and trigger volume.
+	void createDefaultScene(unsigned int stackHeight = 5u, unsigned int stackWidth = 5u);
+	//Creates every actor of "description" and inserts them with one PxScene::addActors() call.
+	//Dynamic bodies get analytic mass and inertia, a camera sphere is added when the description has none.
+	//Boxes and spheres share their shapes through the shape registry unless shape sharing is disabled.
+	void buildScene(const SceneDescription& description);
+	//Writes every scene actor except projectiles to a PxSerialization binary collection. Actors get stable ids
+	//from their role and index in the tracking containers, so the order of the render lists survives a reload.
+	bool saveSnapshot(const std::string& path);
+	//Deserializes a snapshot in place from a copy on write mapping and adds it to the scene, which must be empty.
+	//Sleeping bodies stay asleep, so a settled scene does not have to settle again. The mapping lives until release().
+	bool loadSnapshot(const std::string& path);
+	//Advances the scene by exactly one fixed step and blocks until results are ready.
+	void step();
+	//Starts one fixed step on the worker threads and returns immediately.
+	void beginStep();
+	//Collects results of beginStep(). With "block" false it only polls and returns false while the step is still running.
+	bool endStep(bool block);
+	//True between beginStep() and a successful endStep(). Scene must not be modified or read in that window.
+	bool isStepping() const;
+	//Shutdown PhysX as reverse order of creation.
+	void release();
+
+	//Projectiles share one sphere shape and its cached mass properties.
+	physx::PxRigidDynamic* createSphereProjectile(const physx::PxVec3& position, const physx::PxVec3& velocity);
+	//Removes actor from tracking containers and releases it. Actor is removed from the scene by PhysX.
+	void releaseDynamic(physx::PxRigidDynamic* actor);
+	//Same as releaseDynamic() for every actor of "actors", but walks the tracking containers once. Duplicates are released once.
+	void releaseDynamics(const std::vector<physx::PxRigidDynamic*>& actors);
+
+	physx::PxPhysics* getPhysics() const;
+	physx::PxScene* getScene() const;
+	physx::PxMaterial* getMaterial() const;
+	physx::PxRigidDynamic* getCameraActor() const;
+	//First trigger of the scene, null when it has none.
+	physx::PxRigidStatic* getTriggerActor() const;
+	//Closes a profiler step after every fetched step, null detaches it. The profiler must already be registered
+	//with PxSetProfilerCallback() and must outlive the world.
+	void setPhysXProfiler(PhysXProfiler* profiler);
+	//Contact and trigger events of fetched steps. Drain it after every endStep() or step().
+	CollisionCallback& getCollisionCallback();
+	//With sharing disabled every box and sphere of buildScene() gets an exclusive shape, as before the registry.
+	void setShapeSharing(bool enabled);
+	//With integration enabled exclusive boxes and spheres of buildScene() get their mass from
+	//PxRigidBodyExt::updateMassAndInertia() instead of closed forms, as before both. Shared shapes are not affected.
+	void setMassIntegration(bool enabled);
+	const ShapeRegistry& getShapeRegistry() const;
+	//Bytes PhysX currently holds through the foundation allocator.
+	size_t getAllocatedBytes() const;
+
+	//Rigidbody dynamic container for tracking physics objects.
+	std::vector<physx::PxRigidDynamic*>& getRigidbodyDynamic();
+	//Projectile dynamic container for tracking camera projectiles.
+	std::vector<physx::PxRigidDynamic*>& getProjectileDynamic();
+	//Static boxes created by buildScene(), planes and triggers are not included.
+	const std::vector<physx::PxRigidStatic*>& getRigidbodyStatic() const;
+
+private:
+	//Without "dispatcher" a PxDefaultCpuDispatcher with "workerCount" threads is created and owned.
+	void createWorld(physx::PxCpuDispatcher* dispatcher, physx::PxU32 workerCount, bool enhancedDeterminism);
+	//Kinematic sphere following the camera, left out of scene queries. Not added to the scene.
+	physx::PxRigidDynamic* createCameraActor(float radius);
+	//MBP only, covers the bounds of all tracked bodies with regions once the first actors are in the scene.
+	void setupBroadPhaseRegions();
+
+	TrackingAllocator pAllocator;
+	physx::PxDefaultErrorCallback pError;
+
+	physx::PxFoundation* pFoundation;
+	physx::PxPhysics* pPhysics;
+	//Only set when the world created its own dispatcher.
+	physx::PxDefaultCpuDispatcher* pDispatcher;
+	physx::PxScene* pScene;
+	physx::PxMaterial* pMaterial;
+	physx::PxSerializationRegistry* pSerializationRegistry;
+
+	physx::PxRigidDynamic* pCameraActor;
+	physx::PxRigidStatic* pTriggerActor;
+
+	std::vector<physx::PxRigidDynamic*> rigidbodyDynamic;
+	std::vector<physx::PxRigidDynamic*> projectileDynamic;
+	std::vector<physx::PxRigidStatic*> rigidbodyStatic;
+
+	//Deserialized objects live inside this mapping, it is closed after PxPhysics is released.
+	MappedFile snapshotFile;
+	CollisionCallback collisionCallback;
+	SceneConfig sceneConfig;
+	ShapeRegistry shapeRegistry;
+	PhysXProfiler* physxProfiler;
+	bool shareShapes;
+	bool integrateMass;
+	bool stepping;
+};
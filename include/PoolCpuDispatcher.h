@@ -0,0 +1,19 @@
+#pragma once
+
+#include "PxPhysicsAPI.h"
+
+#include "ThreadPool.h"
+
+//PhysX cpu dispatcher that runs simulation tasks on a ThreadPool shared with the rest of the application.
+//The pool must outlive every scene created with this dispatcher.
+class PoolCpuDispatcher : public physx::PxCpuDispatcher
+{
+public:
+	explicit PoolCpuDispatcher(ThreadPool& threadPool);
+
+	void submitTask(physx::PxBaseTask& task) override;
+	physx::PxU32 getWorkerCount() const override;
+
+private:
+	ThreadPool& pool;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "PxPhysicsAPI.h"
+
+#include "PhysicsWorld.h"
+#include "TransformCache.h"
+
+//Fixed set of sphere projectiles created once at startup. Inactive projectiles stay in the scene
+//with PxActorFlag::eDISABLE_SIMULATION, so firing and culling never allocate PhysX objects.
+class ProjectilePool
+{
+public:
+	ProjectilePool();
+
+	//Creates "capacity" sphere actors and adds them to the scene in disabled state.
+	void initialise(PhysicsWorld& world, unsigned int capacity = 256u);
+	//Activates a free projectile. When the pool is exhausted the oldest active projectile is recycled.
+	//Must not be called while a step is running.
+	physx::PxRigidDynamic* spawn(const physx::PxVec3& position, const physx::PxVec3& velocity, TransformCache& cache);
+	//Deactivates projectiles farther than "threshold" from "viewPos" and returns how many were culled.
+	//Must not be called while a step is running.
+	unsigned int cull(const physx::PxVec3& viewPos, float threshold, TransformCache& cache);
+
+	unsigned int getActiveCount() const;
+	unsigned int getCapacity() const;
+	unsigned long long getRecycledCount() const;
+
+private:
+	struct Projectile
+	{
+		physx::PxRigidDynamic* actor;
+		unsigned long long spawnId;
+	};
+
+	void deactivate(unsigned int activeIndex, TransformCache& cache);
+
+	std::vector<Projectile> projectiles;
+	//Indices into "projectiles". Active ones are removed with swap and pop.
+	std::vector<unsigned int> active;
+	std::vector<unsigned int> freeList;
+	unsigned long long spawnCounter;
+	unsigned long long recycledCount;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+
+#include "PxPhysicsAPI.h"
+
+//Scene creation options PhysicsWorld applies to its PxSceneDesc. A default constructed config takes every
+//value from PxSceneDesc's own defaults, so it creates the same scene as before the options existed.
+struct SceneConfig
+{
+	physx::PxBroadPhaseType::Enum broadPhase;
+	physx::PxSolverType::Enum solver;
+	physx::PxFrictionType::Enum friction;
+	//PxSceneFlag::eENABLE_PCM, eENABLE_STABILIZATION and eENABLE_CCD.
+	bool pcm;
+	bool stabilization;
+	//Scene wide switch, only projectiles get PxRigidBodyFlag::eENABLE_CCD.
+	bool ccd;
+	//MBP only. The bounds of all bodies are grown by "mbpMargin" on every side and split into
+	//"mbpSubdivisions" x "mbpSubdivisions" regions on the ground plane.
+	float mbpMargin;
+	physx::PxU32 mbpSubdivisions;
+
+	SceneConfig();
+	//Short form for tables and logs, e.g. "MBP TGS patch pcm ccd".
+	std::string getName() const;
+};
+
+//Option names are lower case: "sap", "mbp", "abp", "pabp", "pgs", "tgs", "patch", "one" and "two".
+//Unknown names print an error and return false, "value" is left unchanged.
+bool parseBroadPhaseType(const char* name, physx::PxBroadPhaseType::Enum& value);
+bool parseSolverType(const char* name, physx::PxSolverType::Enum& value);
+bool parseFrictionType(const char* name, physx::PxFrictionType::Enum& value);
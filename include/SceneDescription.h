@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Scene files describe physics content without recompiling. The text form is for authoring, the binary form
+//(written with saveSceneBinary) is the same records as raw arrays and loads without parsing.
+//
+//Text form, one element per line, '#' starts a comment. Positions are x y z, sizes are half extents.
+//Optional density (default 1) and material name (default "default") may follow in any order.
+//Counts are whole numbers, one element expands to at most 2^24 bodies. Sizes, spacing and density must be above zero.
+//  material <name> <static friction> <dynamic friction> <restitution>
+//  plane [material]                                          ground plane through the origin, normal +y
+//  box <x y z> <hx hy hz> [density] [material]               dynamic box
+//  sphere <x y z> <radius> [density] [material]              dynamic sphere
+//  static_box <x y z> <hx hy hz> [material]                  static box
+//  stack <x y z> <width> <height> <half extent> [density] [material]
+//  pyramid <x y z> <base> <half extent> [density] [material]
+//  grid <x y z> <nx ny nz> <spacing> <half extent> [density] [material]
+//  trigger <x y z> <hx hy hz>                                trigger volume, the first one is drawn
+//  camera <radius>                                           kinematic camera sphere, 0.3 when omitted
+
+enum class SceneElementType : uint32_t
+{
+	Plane,
+	Box,
+	Sphere,
+	StaticBox,
+	Stack,
+	Pyramid,
+	Grid,
+	Trigger,
+	Camera
+};
+
+struct SceneMaterial
+{
+	float staticFriction;
+	float dynamicFriction;
+	float restitution;
+};
+
+//Fixed size record shared by every element type, unused fields are zero.
+struct SceneElement
+{
+	SceneElementType type;
+	uint32_t material;
+	uint32_t counts[3];
+	float position[3];
+	float size[3];
+	float spacing;
+	float density;
+};
+
+struct SceneDescription
+{
+	//Index 0 is always the default material (0.5, 0.5, 0.5).
+	std::vector<SceneMaterial> materials;
+	std::vector<SceneElement> elements;
+
+	SceneDescription();
+	//Number of actors the elements expand to, camera included.
+	size_t getActorCount() const;
+};
+
+//Loads either form, binary files are detected by their magic. Prints an error and returns false on failure.
+bool loadSceneDescription(const std::string& path, SceneDescription& description);
+bool parseSceneText(const std::string& text, SceneDescription& description, const std::string& sourceName = "<memory>");
+bool saveSceneBinary(const std::string& path, const SceneDescription& description);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "PxPhysicsAPI.h"
+
+#include "ThreadPool.h"
+
+//Closest blocking hit of one raycast or sweep. "actor" is null when nothing was hit.
+struct QueryHit
+{
+	physx::PxRigidActor* actor;
+	physx::PxShape* shape;
+	physx::PxVec3 position;
+	physx::PxVec3 normal;
+	physx::PxReal distance;
+};
+
+//Collects raycast, sweep and overlap requests during a frame and runs them as one batch on the thread pool,
+//between fetchResults() and the next simulate(). Results are written into arrays that only grow, so
+//steady state frames do not allocate. Requests added during a frame are answered by the next execute().
+class SceneQueryService
+{
+public:
+	//Touches kept per overlap request. An overlap that fills every slot may have lost further touches.
+	static constexpr physx::PxU32 maxOverlapHits = 32u;
+
+	//Requests are split into chunks of "grainSize" across the pool's workers and the calling thread.
+	explicit SceneQueryService(ThreadPool& threadPool, unsigned int grainSize = 64u);
+
+	//Returns the request's index into the results of the next execute(). "direction" must be normalised.
+	//Safe to call from any thread, but not while execute() runs.
+	unsigned int addRaycast(const physx::PxVec3& origin, const physx::PxVec3& direction, physx::PxReal distance);
+	unsigned int addSweep(const physx::PxGeometry& geometry, const physx::PxTransform& pose, const physx::PxVec3& direction, physx::PxReal distance);
+	unsigned int addOverlap(const physx::PxGeometry& geometry, const physx::PxTransform& pose);
+
+	//Runs every pending request against "scene" under its read lock and replaces the previous results.
+	//The scene must not be simulating. Returns the number of requests executed.
+	unsigned int execute(physx::PxScene* scene);
+
+	unsigned int getRaycastCount() const;
+	unsigned int getSweepCount() const;
+	unsigned int getOverlapCount() const;
+	const QueryHit& getRaycastHit(unsigned int index) const;
+	const QueryHit& getSweepHit(unsigned int index) const;
+	//Touching shapes of overlap "index", "count" is set to their number.
+	const physx::PxOverlapHit* getOverlapHits(unsigned int index, physx::PxU32& count) const;
+
+	//Wall time of the last execute() in milliseconds.
+	double getLastExecuteTime() const;
+	//Overlap requests that filled all maxOverlapHits slots since creation.
+	unsigned long long getFullOverlapCount() const;
+
+private:
+	struct RaycastRequest
+	{
+		physx::PxVec3 origin;
+		physx::PxVec3 direction;
+		physx::PxReal distance;
+	};
+
+	struct ShapeRequest
+	{
+		physx::PxGeometryHolder geometry;
+		physx::PxTransform pose;
+		physx::PxVec3 direction;
+		physx::PxReal distance;
+	};
+
+	//Runs requests [begin, end) of the combined raycast, sweep and overlap index space.
+	void runRange(physx::PxScene* scene, unsigned int begin, unsigned int end);
+
+	ThreadPool& pool;
+	unsigned int grain;
+	std::mutex requestMutex;
+
+	//Pending requests of the current frame.
+	std::vector<RaycastRequest> pendingRaycasts;
+	std::vector<ShapeRequest> pendingSweeps;
+	std::vector<ShapeRequest> pendingOverlaps;
+	//Requests of the last execute(), swapped with the pending ones so both keep their capacity.
+	std::vector<RaycastRequest> raycasts;
+	std::vector<ShapeRequest> sweeps;
+	std::vector<ShapeRequest> overlaps;
+
+	std::vector<QueryHit> raycastHits;
+	std::vector<QueryHit> sweepHits;
+	//maxOverlapHits slots per overlap request, touches are written straight into the request's slots.
+	std::vector<physx::PxOverlapHit> overlapHits;
+	std::vector<physx::PxU32> overlapHitCounts;
+
+	double lastExecuteTime;
+	std::atomic<unsigned long long> fullOverlapCount;
+};
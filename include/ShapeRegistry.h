@@ -0,0 +1,60 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "PxPhysicsAPI.h"
+
+//Shape shared by every actor with the same geometry, material and flags, plus its mass properties at unit density.
+struct SharedShape
+{
+	physx::PxShape* shape;
+	//Mass at density 1, i.e. the volume. Actor mass is density * unitMass.
+	physx::PxReal unitMass;
+	//Principal inertia per unit mass. Actor inertia is mass * unitInertia.
+	physx::PxVec3 unitInertia;
+	//Centre of mass and principal axes in shape space.
+	physx::PxTransform massFrame;
+};
+
+//Hands out non exclusive PxShapes keyed by geometry, material and shape flags, so thousands of identical bodies
+//reference one shape instead of owning a copy each. Mass properties are computed once per shape and applied
+//with setMass() and setMassSpaceInertiaTensor() instead of PxRigidBodyExt::updateMassAndInertia().
+//Only box, sphere, capsule and plane geometries are supported. Not thread safe.
+class ShapeRegistry
+{
+public:
+	ShapeRegistry();
+
+	void initialise(physx::PxPhysics* physics);
+	//Returns the shared shape of this combination, creating it on first use. Null for unsupported geometries.
+	const SharedShape* acquire(const physx::PxGeometry& geometry, const physx::PxMaterial& material,
+		physx::PxShapeFlags flags = physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eSCENE_QUERY_SHAPE | physx::PxShapeFlag::eSIMULATION_SHAPE);
+	//Attaches "shape" and sets mass, inertia and centre of mass for "density". Use for single shape bodies only.
+	static void attach(physx::PxRigidDynamic& actor, const SharedShape& shape, physx::PxReal density);
+	//Drops the registry's shape references, attached actors keep theirs. Must run before PxPhysics is released.
+	void release();
+
+	unsigned int getShapeCount() const;
+	//acquire() calls that found an existing shape.
+	unsigned long long getHitCount() const;
+
+private:
+	struct ShapeKey
+	{
+		physx::PxGeometryType::Enum type;
+		physx::PxReal dimensions[3];
+		const physx::PxMaterial* material;
+		physx::PxU32 flags;
+
+		bool operator==(const ShapeKey& other) const;
+	};
+
+	struct ShapeKeyHash
+	{
+		size_t operator()(const ShapeKey& key) const;
+	};
+
+	physx::PxPhysics* pPhysics;
+	std::unordered_map<ShapeKey, SharedShape, ShapeKeyHash> shapes;
+	unsigned long long hitCount;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+//Bounded single producer / single consumer ring buffer. Storage is allocated once in the constructor,
+//push() and pop() never allocate or lock. Capacity is rounded up to a power of two.
+template <typename T>
+class SpscRing
+{
+public:
+	explicit SpscRing(size_t requestedCapacity) :
+		mask(0u),
+		writeIndex(0u),
+		readIndex(0u)
+	{
+		size_t capacity = 1u;
+		while (capacity < requestedCapacity)
+			capacity <<= 1u;
+
+		buffer.resize(capacity);
+		mask = capacity - 1u;
+	}
+
+	//Producer side. Returns false when the ring is full, item is not stored in that case.
+	bool push(const T& item)
+	{
+		const size_t head = writeIndex.load(std::memory_order_relaxed);
+		const size_t tail = readIndex.load(std::memory_order_acquire);
+		if (head - tail > mask)
+			return false;
+
+		buffer[head & mask] = item;
+		writeIndex.store(head + 1u, std::memory_order_release);
+		return true;
+	}
+
+	//Consumer side. Returns false when the ring is empty.
+	bool pop(T& item)
+	{
+		const size_t tail = readIndex.load(std::memory_order_relaxed);
+		const size_t head = writeIndex.load(std::memory_order_acquire);
+		if (tail == head)
+			return false;
+
+		item = buffer[tail & mask];
+		readIndex.store(tail + 1u, std::memory_order_release);
+		return true;
+	}
+
+	size_t size() const
+	{
+		return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+	}
+
+	size_t capacity() const
+	{
+		return mask + 1u;
+	}
+
+private:
+	std::vector<T> buffer;
+	size_t mask;
+	//Indices live on separate cache lines so producer and consumer do not false share.
+	alignas(64) std::atomic<size_t> writeIndex;
+	alignas(64) std::atomic<size_t> readIndex;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+
+//Sub-allocation of the current frame's region. "data" points into persistently mapped memory and is null when
+//the region was full, callers then fall back to their own upload path for this frame.
+struct StreamAllocation
+{
+	void* data;
+	//Byte offset into the stream buffer, for glBindBufferRange() and glCopyBufferSubData().
+	size_t offset;
+	size_t size;
+};
+
+//Persistently and coherently mapped buffer split into "regionCount" regions, one per frame in flight. Per-frame
+//data is written straight into mapped memory, so the driver never has to copy or orphan anything. A fence guards
+//every region, beginFrame() waits on it before the region is reused and records how long that took.
+//If a frame runs out of space, every region is grown at the next beginFrame().
+//Must be constructed with a current GL context and only used from the thread owning it.
+class StreamBuffer
+{
+public:
+	StreamBuffer(size_t regionSize = 4u << 20, unsigned int regionCount = 3u);
+
+	//Moves to the next region and waits until the GPU is done reading it.
+	void beginFrame();
+	//Fences the current region. Call after the last draw call that reads this frame's allocations.
+	void endFrame();
+
+	//Returns "size" bytes aligned to "alignment", which must be a power of two.
+	StreamAllocation allocate(size_t size, size_t alignment = 16u);
+	//Waits for and deletes outstanding fences, unmaps and deletes the buffer. Call before the GL context is
+	//destroyed, the stream must not be used afterwards. Safe to call more than once.
+	void release();
+	void bindRange(GLenum target, unsigned int index, const StreamAllocation& allocation) const;
+
+	unsigned int getBuffer() const;
+	//Offset alignments required by glBindBufferRange() for uniform and shader storage blocks.
+	size_t getUniformAlignment() const;
+	size_t getStorageAlignment() const;
+	size_t getRegionSize() const;
+
+	//Milliseconds beginFrame() waited on a fence, last frame and in total. Non-zero means the CPU is running
+	//more than regionCount - 1 frames ahead of the GPU.
+	double getLastWaitTime() const;
+	double getTotalWaitTime() const;
+	//Frames whose region was still in use by the GPU.
+	unsigned long long getWaitCount() const;
+	//Allocations that did not fit into their region.
+	unsigned long long getOverflowCount() const;
+
+private:
+	void create(size_t size);
+	void destroy();
+
+	unsigned int buffer;
+	unsigned char* mappedData;
+	size_t regionBytes;
+	unsigned int regions;
+	unsigned int currentRegion;
+	size_t regionOffset;
+	//Bytes the current frame asked for, including allocations that failed.
+	size_t requestedBytes;
+	bool growRegions;
+	std::vector<GLsync> fences;
+	size_t uniformAlignment;
+	size_t storageAlignment;
+	double lastWaitTime;
+	double totalWaitTime;
+	unsigned long long waitCount;
+	unsigned long long overflowCount;
+};
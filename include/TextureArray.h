@@ -0,0 +1,51 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+class AsyncTextureLoader;
+
+//Square RGBA8 2D texture array holding one layer per distinct source texture, so draws with different
+//textures can be merged into one multi draw call and pick their layer per draw. Sources of any size are
+//scaled into their layer on the GPU with glBlitFramebuffer. Layer 0 is a grey placeholder for untextured meshes.
+//Sources are copied as raw values, sRGB textures are not decoded.
+//Must be constructed with a current GL context and only used from the thread owning it.
+class TextureArray
+{
+public:
+	//Texture unit the array is bound to, main.frag's "textureArray" sampler must be set to it.
+	static constexpr unsigned int textureUnit = 1u;
+
+	TextureArray(int layerSize = 512, unsigned int maxLayerCount = 16u);
+
+	//Returns the layer of "textureId", adding it on first use. Returns 0 when every layer is taken.
+	unsigned int addLayer(unsigned int textureId);
+	//Copies sources that became resident into their layers. Returns how many layers were copied.
+	unsigned int update(const AsyncTextureLoader* loader);
+	void bind() const;
+	//Deletes the array texture and the blit framebuffers. Call before the GL context is destroyed, the destructor
+	//does not touch GL. Safe to call more than once.
+	void release();
+
+	unsigned int getLayerCount() const;
+
+private:
+	struct Layer
+	{
+		unsigned int textureId;
+		bool copied;
+	};
+
+	void copyLayer(unsigned int layer);
+
+	unsigned int textureArray;
+	unsigned int readFramebuffer;
+	unsigned int drawFramebuffer;
+	int size;
+	unsigned int maxLayers;
+	//Index 0 is the placeholder and has no source.
+	std::vector<Layer> layers;
+	std::unordered_map<unsigned int, unsigned int> layersByTexture;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include <glad/glad.h>
+
+class AsyncTextureLoader;
+
+//Process wide texture cache keyed by normalized absolute path and gamma flag. Each acquire() adds a reference,
+//the GL texture is deleted when the last reference is released. Wrap mode is decided by the first acquire.
+class TextureCache
+{
+public:
+	static TextureCache& instance();
+
+	//Returns the texture of "path", loading it on first use. With "loader" the texture is decoded in the background
+	//and shows a placeholder until it is uploaded. Returns 0 when a synchronous load fails.
+	unsigned int acquire(const std::string& path, bool gamma = false, GLint wrapMode = GL_REPEAT, AsyncTextureLoader* loader = nullptr);
+	//Adds a reference to a texture returned by acquire().
+	void retain(unsigned int textureId);
+	//Drops a reference. Unknown ids, including every id after releaseAll(), are ignored.
+	void release(unsigned int textureId);
+	//Deletes every texture regardless of references. Must run while the GL context is still current.
+	void releaseAll();
+
+	unsigned int getTextureCount() const;
+	unsigned long long getHitCount() const;
+
+	static std::string normalizePath(const std::string& path);
+
+private:
+	TextureCache();
+
+	struct Entry
+	{
+		std::string key;
+		unsigned int referenceCount;
+		AsyncTextureLoader* loader;
+	};
+
+	std::unordered_map<std::string, unsigned int> idsByKey;
+	std::unordered_map<unsigned int, Entry> entries;
+	unsigned long long hitCount;
+};
+
+//Owns one reference of a cached texture. Copies add a reference, destruction releases it.
+class TextureHandle
+{
+public:
+	TextureHandle();
+	//Adopts a reference that was returned by TextureCache::acquire().
+	explicit TextureHandle(unsigned int textureId);
+	TextureHandle(const TextureHandle& other);
+	TextureHandle(TextureHandle&& other) noexcept;
+	TextureHandle& operator=(TextureHandle other) noexcept;
+	~TextureHandle();
+
+	unsigned int get() const;
+
+private:
+	unsigned int id;
+};
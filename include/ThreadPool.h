@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Work stealing thread pool shared by PhysX (through PoolCpuDispatcher) and application work.
+//Each worker owns a queue. Jobs submitted from a worker go to its own queue and are taken LIFO,
+//idle workers steal FIFO from the other queues. Jobs submitted from other threads are spread round robin.
+class ThreadPool
+{
+public:
+	typedef std::function<void()> Job;
+
+	ThreadPool();
+	~ThreadPool();
+
+	//Starts "workerCount" threads. With "pinToCores" worker i is pinned to logical core (firstCore + i).
+	void initialise(unsigned int workerCount, bool pinToCores = false, unsigned int firstCore = 0u);
+	//Runs every queued job, then joins the workers. Safe to call more than once.
+	void shutdown();
+
+	//Queues a job. Without workers the job runs immediately on the calling thread.
+	void submit(Job job);
+	//Splits [begin, end) into chunks of "grainSize" and runs "body(chunkBegin, chunkEnd)" on the workers
+	//and the calling thread. Blocks until every chunk is done. Single chunk ranges run inline.
+	void parallelFor(unsigned int begin, unsigned int end, unsigned int grainSize, const std::function<void(unsigned int, unsigned int)>& body);
+
+	unsigned int getWorkerCount() const;
+	//Number of jobs a worker took from another worker's queue.
+	unsigned long long getStealCount() const;
+
+	//One worker per logical core minus the main thread, at least one.
+	static unsigned int getDefaultWorkerCount();
+
+private:
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	void workerLoop(unsigned int index);
+	bool popLocal(unsigned int index, Job& job);
+	bool steal(unsigned int index, Job& job);
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+	std::vector<std::thread> workers;
+
+	std::mutex sleepMutex;
+	std::condition_variable wakeCondition;
+	std::atomic<unsigned int> pendingJobs;
+	std::atomic<unsigned int> sleepingWorkers;
+	std::atomic<unsigned int> nextQueue;
+	std::atomic<unsigned long long> stealCount;
+	std::atomic<bool> running;
+};
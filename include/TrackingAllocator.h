@@ -0,0 +1,25 @@
+#pragma once
+
+#include <atomic>
+
+#include "PxPhysicsAPI.h"
+
+//PxDefaultAllocator that counts live bytes, so the PhysX heap footprint of a scene can be measured.
+//Each block carries a 16 byte header holding its size, which keeps the 16 byte alignment PhysX requires.
+class TrackingAllocator : public physx::PxAllocatorCallback
+{
+public:
+	TrackingAllocator();
+
+	void* allocate(size_t size, const char* typeName, const char* filename, int line) override;
+	void deallocate(void* ptr) override;
+
+	//Bytes currently allocated by PhysX, headers excluded.
+	size_t getLiveBytes() const;
+	size_t getPeakBytes() const;
+
+private:
+	physx::PxDefaultAllocator allocator;
+	std::atomic<size_t> liveBytes;
+	std::atomic<size_t> peakBytes;
+};
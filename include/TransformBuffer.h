@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "StreamBuffer.h"
+#include "ThreadPool.h"
+#include "TransformCache.h"
+
+//Persistent model matrices of one body mesh, indexed by TransformCache render slot. Only slots of awake bodies
+//and slots the cache reports dirty are rewritten, sleeping bodies keep the transform uploaded when they fell asleep.
+//Written ranges are staged in a StreamBuffer and copied into place on the GPU. The slots that passed frustum
+//culling are a second storage block, rewritten only when the list changes. main.vert reads it with gl_InstanceID.
+class TransformBuffer
+{
+public:
+	TransformBuffer(unsigned int transformBindingIndex = 0u, unsigned int visibleBindingIndex = 1u);
+
+	//Writes dirty slots with their latest pose and awake slots interpolated by "alpha", then uploads the
+	//written ranges. Returns the number of slots written. Must not run while the cache is being updated.
+	unsigned int update(TransformCache& cache, BodyMesh mesh, float alpha, ThreadPool& pool, StreamBuffer& stream);
+	//Sets the slots drawn by the next instanced draw calls. Uploads nothing when "slots" equals the current list.
+	void setVisibleSlots(const std::vector<unsigned int>& slots, StreamBuffer& stream);
+	//Binds both storage blocks to the binding points declared in main.vert.
+	void bind() const;
+	//Deletes both storage buffers. Call before the GL context is destroyed, the destructor does not touch GL.
+	//Safe to call more than once.
+	void release();
+
+	unsigned int getVisibleCount() const;
+	//Bytes of transforms and visible slots uploaded since creation, streamed or not.
+	unsigned long long getUploadedBytes() const;
+
+private:
+	struct UploadRange
+	{
+		unsigned int first;
+		unsigned int count;
+	};
+
+	void uploadTransforms(StreamBuffer& stream);
+
+	//CPU mirror, merged ranges may include slots that were not written this frame.
+	std::vector<glm::mat4> transforms;
+	//Scratch lists reused every frame.
+	std::vector<unsigned int> dirtySlots;
+	std::vector<unsigned int> writtenSlots;
+	std::vector<UploadRange> uploadRanges;
+	//Slots currently in visibleSSBO.
+	std::vector<unsigned int> visible;
+	unsigned int transformSSBO;
+	unsigned int visibleSSBO;
+	unsigned int transformBinding;
+	unsigned int visibleBinding;
+	size_t transformCapacity;
+	size_t visibleCapacity;
+	unsigned long long uploadedBytes;
+};
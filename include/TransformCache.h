@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "PxPhysicsAPI.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "FrustumCuller.h"
+#include "CollisionCallback.h"
+
+//Mesh used to represent a dynamic body on screen. Every mesh has its own render slots.
+enum class BodyMesh : unsigned int
+{
+	Cube = 0u,
+	Sphere = 1u,
+	Count = 2u
+};
+
+//Poses of one body around the latest step. "movedStep" is the step in which "current" was written.
+struct BodyPose
+{
+	physx::PxTransform previous;
+	physx::PxTransform current;
+	unsigned long long movedStep;
+	//World bounds at "current".
+	physx::PxBounds3 bounds;
+	//Mesh scale, half extents of a box or radius of a sphere.
+	glm::vec3 scale;
+	//Position in the awake list of its mesh, TransformCache::notAwake while asleep.
+	unsigned int awakeIndex;
+	//Queued in the dirty list of its mesh.
+	bool dirty;
+};
+
+//Render side copy of dynamic body poses. Each tracked actor stores its render slot in PxActor::userData,
+//so after a step only the actors reported by PxScene::getActiveActors() have to be read back.
+//Per mesh it also keeps the set of awake slots and a list of dirty slots, so GPU transforms of sleeping
+//bodies are written once when they fall asleep and never again until they wake up.
+class TransformCache
+{
+public:
+	static constexpr unsigned int notAwake = ~0u;
+
+	TransformCache();
+
+	//Bodies are tracked awake unless the actor is sleeping when added. Actors need PxActorFlag::eSEND_SLEEP_NOTIFIES
+	//to ever leave the awake set.
+	void addBody(physx::PxRigidDynamic* actor, BodyMesh mesh, const glm::vec3& scale = glm::vec3(1.f));
+	//Picks mesh and scale from the actor's first shape. Actors without a box or sphere shape are not tracked.
+	bool addBody(physx::PxRigidDynamic* actor);
+	//Swap and pop removal. Clears userData of removed actor and patches userData of moved one.
+	void removeBody(physx::PxRigidDynamic* actor);
+	//Copies poses of actors moved during the last simulate() call. Must be called after fetchResults()
+	//and before any actor is released, active actor buffer is only valid until then.
+	unsigned int updateFromActiveActors(physx::PxScene* scene);
+	//Applies sleep and wake notifications of the fetched step. Call after updateFromActiveActors(), a body that
+	//fell asleep is queued dirty once so its final pose reaches the GPU.
+	void applySleepTransitions(CollisionCallback& callback);
+
+	unsigned int getBodyCount(BodyMesh mesh) const;
+	physx::PxRigidDynamic* getActor(BodyMesh mesh, unsigned int index) const;
+	const physx::PxTransform& getPose(BodyMesh mesh, unsigned int index) const;
+	//Pose of a tracked actor, looked up through its userData.
+	const physx::PxTransform& getPose(const physx::PxRigidDynamic* actor) const;
+	//Model matrix between the previous and the latest step. Bodies that did not move in the latest step are not interpolated.
+	glm::mat4 getInterpolatedMatrix(BodyMesh mesh, unsigned int index, float alpha) const;
+
+	//Culling bounds of every slot, the union of world bounds at the previous and current pose
+	//so interpolated bodies are never culled early.
+	const BoundsSoA& getCullBounds(BodyMesh mesh) const;
+
+	//Number of poses copied by the last updateFromActiveActors() call.
+	unsigned int getLastUpdateCount() const;
+
+	//Slots whose interpolated matrix changes every frame.
+	const std::vector<unsigned int>& getAwakeSlots(BodyMesh mesh) const;
+	//Moves slots changed outside the awake set (added, moved by removal, fallen asleep) into "slots".
+	//Entries may be out of range after removals and must be skipped.
+	void takeDirtySlots(BodyMesh mesh, std::vector<unsigned int>& slots);
+
+private:
+	static void* encodeSlot(BodyMesh mesh, unsigned int index);
+	static bool decodeSlot(const void* userData, BodyMesh& mesh, unsigned int& index);
+	void addAwake(unsigned int mesh, unsigned int index);
+	void removeAwake(unsigned int mesh, unsigned int index);
+	void markDirty(unsigned int mesh, unsigned int index);
+
+	std::vector<physx::PxRigidDynamic*> actors[(unsigned int)BodyMesh::Count];
+	std::vector<BodyPose> poses[(unsigned int)BodyMesh::Count];
+	BoundsSoA cullBounds[(unsigned int)BodyMesh::Count];
+	std::vector<unsigned int> awakeSlots[(unsigned int)BodyMesh::Count];
+	std::vector<unsigned int> dirtySlots[(unsigned int)BodyMesh::Count];
+	std::vector<SleepTransition> transitionScratch;
+	unsigned int lastUpdateCount;
+	unsigned long long latestStep;
+};
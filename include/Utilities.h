@@ -8,5 +8,9 @@
 
 float alip(float a, float b, float f);
 void renderCube();
+void renderCubeInstanced(unsigned int instanceCount);
 void renderQuad();
+//Loads through TextureCache, the texture stays alive until TextureCache::releaseAll(). Exits on failure.
 unsigned int loadTextureFromFile(const char* path);
+//Decodes and uploads without caching. Returns 0 on failure.
+unsigned int uploadTextureFromFile(const char* path, bool gamma, GLint wrapMode);
@@ -1,16 +1,21 @@
 #version 460 core
 
 in vec2 vTexCoords;
+flat in float vTextureLayer;
 
 out vec4 fragColor;
 
 uniform sampler2D texture_diffuse0;
+uniform sampler2DArray textureArray;
+uniform bool isTextureArray = false;
 uniform bool isWireframe = false;
 
 void main()
 {
 	if(isWireframe)
 		fragColor = vec4(0.f,1.f,0.f,1.f);
+	else if(isTextureArray)
+		fragColor = vec4(texture(textureArray, vec3(vTexCoords, vTextureLayer)).rgb, 1.f);
 	else
 		fragColor = vec4(texture(texture_diffuse0, vTexCoords).rgb, 1.f);
 }
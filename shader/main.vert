@@ -4,14 +4,36 @@ layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec2 texCoords;
 
+//Model matrices of every body of one mesh, indexed by render slot.
+layout(std430, binding = 0) readonly buffer InstanceTransforms
+{
+	mat4 instanceModel[];
+};
+
+//Render slots that passed frustum culling, indexed by gl_InstanceID when isInstanced is set.
+layout(std430, binding = 1) readonly buffer VisibleSlots
+{
+	uint visibleSlot[];
+};
+
+layout(std140, binding = 0) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform bool isInstanced = false;
 
 out vec2 vTexCoords;
+//Texture array layer of arena models, passed as the base instance of their indirect draw commands.
+flat out float vTextureLayer;
 
 void main()
 {
+	mat4 world = isInstanced ? instanceModel[visibleSlot[gl_InstanceID]] : model;
+
 	vTexCoords = texCoords;
-	gl_Position = projection * view * model * vec4(position,1.f);
+	vTextureLayer = float(gl_BaseInstance);
+	gl_Position = projection * view * world * vec4(position,1.f);
 }
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include "AsyncTextureLoader.h"
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <stb_image.h>
+
+AsyncTextureLoader::SharedState::~SharedState()
+{
+	for (DecodedImage& image : completed)
+		stbi_image_free(image.pixels);
+}
+
+AsyncTextureLoader::AsyncTextureLoader(ThreadPool& threadPool, size_t uploadBudgetPerFrame) :
+	pool(threadPool),
+	state(std::make_shared<SharedState>()),
+	nextRequestId(0u),
+	nextPixelBuffer(0u),
+	uploadBudget(uploadBudgetPerFrame),
+	uploadedBytes(0u)
+{
+	glGenBuffers(2, pixelBuffers);
+}
+
+AsyncTextureLoader::~AsyncTextureLoader()
+{
+	for (DecodedImage& image : ready)
+		stbi_image_free(image.pixels);
+}
+
+void AsyncTextureLoader::release()
+{
+	if (pixelBuffers[0] == 0u)
+		return;
+
+	glDeleteBuffers(2, pixelBuffers);
+	pixelBuffers[0] = pixelBuffers[1] = 0u;
+}
+
+unsigned int AsyncTextureLoader::request(const std::string& path, bool gamma, GLint wrapMode)
+{
+	static const unsigned char placeholder[4] = { 128, 128, 128, 255 };
+
+	unsigned int textureId;
+	glGenTextures(1, &textureId);
+	glBindTexture(GL_TEXTURE_2D, textureId);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	unsigned long long requestId = nextRequestId++;
+	pendingRequests[textureId] = requestId;
+	std::shared_ptr<SharedState> sharedState = state;
+	pool.submit([sharedState, textureId, requestId, path, gamma, wrapMode]()
+	{
+		DecodedImage image = { textureId, requestId, path, nullptr, 0, 0, 0, gamma, wrapMode };
+		image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+
+		std::lock_guard<std::mutex> lock(sharedState->mutex);
+		sharedState->completed.push_back(std::move(image));
+	});
+
+	return textureId;
+}
+
+unsigned int AsyncTextureLoader::update()
+{
+	collectCompleted();
+
+	unsigned int uploadedCount = 0u;
+	size_t spentBytes = 0u;
+	while (uploadedCount < ready.size())
+	{
+		const DecodedImage& image = ready[uploadedCount];
+		size_t imageBytes = (size_t)image.width * (size_t)image.height * (size_t)image.channels;
+		if (uploadedCount > 0u && spentBytes + imageBytes > uploadBudget)
+			break;
+
+		upload(image);
+		spentBytes += imageBytes;
+		uploadedCount++;
+	}
+	ready.erase(ready.begin(), ready.begin() + uploadedCount);
+
+	return uploadedCount;
+}
+
+void AsyncTextureLoader::finish()
+{
+	while (!pendingRequests.empty())
+	{
+		collectCompleted();
+		for (const DecodedImage& image : ready)
+			upload(image);
+		ready.clear();
+
+		if (!pendingRequests.empty())
+			std::this_thread::yield();
+	}
+}
+
+void AsyncTextureLoader::cancel(unsigned int textureId)
+{
+	//The decode job cannot be stopped, its result is dropped in upload().
+	pendingRequests.erase(textureId);
+}
+
+bool AsyncTextureLoader::isPending(unsigned int textureId) const
+{
+	return pendingRequests.count(textureId) != 0u;
+}
+
+unsigned int AsyncTextureLoader::getPendingCount() const
+{
+	return (unsigned int)pendingRequests.size();
+}
+
+unsigned long long AsyncTextureLoader::getUploadedBytes() const
+{
+	return uploadedBytes;
+}
+
+void AsyncTextureLoader::collectCompleted()
+{
+	std::lock_guard<std::mutex> lock(state->mutex);
+	ready.insert(ready.end(), state->completed.begin(), state->completed.end());
+	state->completed.clear();
+}
+
+void AsyncTextureLoader::upload(const DecodedImage& image)
+{
+	auto pending = pendingRequests.find(image.textureId);
+	if (pending == pendingRequests.end() || pending->second != image.requestId)
+	{
+		stbi_image_free(image.pixels);
+		return;
+	}
+	pendingRequests.erase(pending);
+
+	if (!image.pixels)
+	{
+		//Keep the placeholder, a missing texture should not take the whole application down mid frame.
+		printf("ERROR: Texture could not load from: %s\n", image.path.c_str());
+		return;
+	}
+
+	GLenum format = GL_RGBA;
+	GLenum internalFormat = image.gamma ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+	if (image.channels == 1)
+	{
+		format = GL_RED;
+		internalFormat = GL_R8;
+	}
+	else if (image.channels == 3)
+	{
+		format = GL_RGB;
+		internalFormat = image.gamma ? GL_SRGB8 : GL_RGB8;
+	}
+	else if (image.channels != 4)
+	{
+		printf("ERROR: Invalid texture format in: %s\n", image.path.c_str());
+		stbi_image_free(image.pixels);
+		return;
+	}
+
+	//Copy into a freshly orphaned PBO, glTexImage2D then sources from GPU visible memory instead of the client pointer.
+	size_t imageBytes = (size_t)image.width * (size_t)image.height * (size_t)image.channels;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[nextPixelBuffer]);
+	nextPixelBuffer = (nextPixelBuffer + 1u) % 2u;
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)imageBytes, nullptr, GL_STREAM_DRAW);
+	void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)imageBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (mapped)
+	{
+		std::memcpy(mapped, image.pixels, imageBytes);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+		//Rows of 1 and 3 channel images are not 4 byte aligned.
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glBindTexture(GL_TEXTURE_2D, image.textureId);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, image.wrapMode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, image.wrapMode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		uploadedBytes += imageBytes;
+	}
+	else
+	{
+		printf("ERROR: Pixel buffer could not be mapped for: %s\n", image.path.c_str());
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	stbi_image_free(image.pixels);
+}
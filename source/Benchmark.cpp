@@ -0,0 +1,482 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "ThreadPool.h"
+#include "PoolCpuDispatcher.h"
+#include "FrustumCuller.h"
+#include "SceneDescription.h"
+#include "SceneQueryService.h"
+
+struct StepStatistics
+{
+	double wallTime;
+	double p50, p90, p99, max;
+	unsigned long long contactEventCount;
+};
+
+//Returns the sample at given percentile. Samples must be sorted in ascending order.
+static double percentile(const std::vector<double>& sortedSamples, double p)
+{
+	if (sortedSamples.empty())
+		return 0.0;
+
+	size_t index = (size_t)(p * (double)(sortedSamples.size() - 1) + 0.5);
+	return sortedSamples[std::min(index, sortedSamples.size() - 1)];
+}
+
+//"beforeStep" runs untimed before every step, it may add or release actors.
+static StepStatistics measureSteps(PhysicsWorld& world, unsigned int stepCount, const std::function<void(unsigned int)>& beforeStep = nullptr)
+{
+	std::vector<double> stepTimes;
+	stepTimes.reserve(stepCount);
+
+	StepStatistics statistics = {};
+	CollisionCallback& callback = world.getCollisionCallback();
+	ContactEvent event;
+	std::vector<SleepTransition> sleepTransitions;
+
+	auto benchmarkStart = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0; i < stepCount; i++)
+	{
+		if (beforeStep)
+			beforeStep(i);
+
+		auto stepStart = std::chrono::high_resolution_clock::now();
+		world.step();
+		auto stepEnd = std::chrono::high_resolution_clock::now();
+		stepTimes.push_back(std::chrono::duration<double, std::milli>(stepEnd - stepStart).count());
+
+		//Drain outside the timed region, consumer cost is not part of the step.
+		while (callback.popEvent(event))
+			statistics.contactEventCount++;
+		//No transform cache tracks sleep state here.
+		callback.takeSleepTransitions(sleepTransitions);
+	}
+	auto benchmarkEnd = std::chrono::high_resolution_clock::now();
+
+	statistics.wallTime = std::chrono::duration<double>(benchmarkEnd - benchmarkStart).count();
+	std::sort(stepTimes.begin(), stepTimes.end());
+	statistics.p50 = percentile(stepTimes, 0.50);
+	statistics.p90 = percentile(stepTimes, 0.90);
+	statistics.p99 = percentile(stepTimes, 0.99);
+	statistics.max = stepTimes.empty() ? 0.0 : stepTimes.back();
+	return statistics;
+}
+
+static double stepsPerSecond(const StepStatistics& statistics, unsigned int stepCount)
+{
+	return statistics.wallTime > 0.0 ? (double)stepCount / statistics.wallTime : 0.0;
+}
+
+void runHeadlessBenchmark(PhysicsWorld& world, unsigned int stepCount)
+{
+	StepStatistics statistics = measureSteps(world, stepCount);
+	CollisionCallback& callback = world.getCollisionCallback();
+
+	printf("Headless benchmark: %u steps, %zu dynamic bodies\n", stepCount, world.getRigidbodyDynamic().size());
+	printf("  wall time     : %.3f s\n", statistics.wallTime);
+	printf("  steps/sec     : %.1f\n", stepsPerSecond(statistics, stepCount));
+	printf("  step p50      : %.3f ms\n", statistics.p50);
+	printf("  step p90      : %.3f ms\n", statistics.p90);
+	printf("  step p99      : %.3f ms\n", statistics.p99);
+	printf("  step max      : %.3f ms\n", statistics.max);
+	printf("  contact events: %llu (dropped %llu, truncated %llu)\n", statistics.contactEventCount, callback.getDroppedEventCount(), callback.getTruncatedContactCount());
+}
+
+void runDispatcherScalingBenchmark(unsigned int stepCount, unsigned int stackSize, unsigned int maxWorkerCount, bool pinToCores,
+	PhysXProfiler* profiler, const std::string& profilePath)
+{
+	printf("Dispatcher scaling benchmark: %u steps, %u dynamic bodies\n", stepCount, stackSize * stackSize);
+	printf("  workers | pool steps/sec | pool p99 ms | default steps/sec | default p99 ms\n");
+
+	for (unsigned int workerCount = 1; workerCount <= maxWorkerCount; workerCount++)
+	{
+		//Every run starts from an identical scene, PhysX allows only one foundation at a time.
+		StepStatistics poolStatistics;
+		{
+			ThreadPool pool;
+			pool.initialise(workerCount, pinToCores);
+			PoolCpuDispatcher dispatcher(pool);
+
+			PhysicsWorld world;
+			world.initialise(&dispatcher);
+			world.setPhysXProfiler(profiler);
+			world.createDefaultScene(stackSize, stackSize);
+			poolStatistics = measureSteps(world, stepCount);
+			world.release();
+		}
+		if (profiler)
+		{
+			profiler->writeHistograms(profilePath, "pool dispatcher, " + std::to_string(workerCount) + " workers", workerCount > 1u);
+			profiler->reset();
+		}
+
+		StepStatistics defaultStatistics;
+		{
+			PhysicsWorld world;
+			world.initialise(workerCount);
+			world.setPhysXProfiler(profiler);
+			world.createDefaultScene(stackSize, stackSize);
+			defaultStatistics = measureSteps(world, stepCount);
+			world.release();
+		}
+		if (profiler)
+		{
+			profiler->writeHistograms(profilePath, "default dispatcher, " + std::to_string(workerCount) + " workers", true);
+			profiler->reset();
+		}
+
+		printf("  %7u | %14.1f | %11.3f | %17.1f | %14.3f\n", workerCount,
+			stepsPerSecond(poolStatistics, stepCount), poolStatistics.p99,
+			stepsPerSecond(defaultStatistics, stepCount), defaultStatistics.p99);
+	}
+}
+
+void runCullingBenchmark(unsigned int bodyCount, unsigned int iterationCount)
+{
+	//Boxes of 1..4 units scattered around a camera at the origin, roughly a quarter ends up visible.
+	std::mt19937 random(12345u);
+	std::uniform_real_distribution<float> position(-500.f, 500.f);
+	std::uniform_real_distribution<float> extent(0.5f, 2.f);
+
+	BoundsSoA bounds;
+	for (unsigned int i = 0; i < bodyCount; i++)
+	{
+		physx::PxVec3 center(position(random), position(random), position(random));
+		physx::PxVec3 halfExtent(extent(random), extent(random), extent(random));
+		bounds.push(physx::PxBounds3(center - halfExtent, center + halfExtent));
+	}
+
+	glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+	glm::mat4 projection = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 1000.f);
+	FrustumCuller culler;
+	culler.setViewProjection(projection * view);
+
+	std::vector<unsigned int> simdVisible, scalarVisible;
+	simdVisible.reserve(bodyCount);
+	scalarVisible.reserve(bodyCount);
+
+	auto simdStart = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0; i < iterationCount; i++)
+	{
+		simdVisible.clear();
+		culler.cull(bounds, simdVisible);
+	}
+	auto simdEnd = std::chrono::high_resolution_clock::now();
+
+	auto scalarStart = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0; i < iterationCount; i++)
+	{
+		scalarVisible.clear();
+		culler.cullScalar(bounds, scalarVisible);
+	}
+	auto scalarEnd = std::chrono::high_resolution_clock::now();
+
+	double simdTime = std::chrono::duration<double, std::milli>(simdEnd - simdStart).count() / (iterationCount > 0u ? iterationCount : 1u);
+	double scalarTime = std::chrono::duration<double, std::milli>(scalarEnd - scalarStart).count() / (iterationCount > 0u ? iterationCount : 1u);
+
+	printf("Culling benchmark: %u bodies, %u iterations, %zu visible\n", bodyCount, iterationCount, simdVisible.size());
+	printf("  simd pass     : %.3f ms (%.1f M bodies/sec)\n", simdTime, simdTime > 0.0 ? bodyCount / simdTime / 1000.0 : 0.0);
+	printf("  scalar pass   : %.3f ms (%.1f M bodies/sec)\n", scalarTime, scalarTime > 0.0 ? bodyCount / scalarTime / 1000.0 : 0.0);
+	printf("  results match : %s\n", simdVisible == scalarVisible ? "yes" : "NO");
+}
+
+void runSceneLoadBenchmark(PhysicsWorld& world, unsigned int bodyCount)
+{
+	//One line per body is the worst case for the parser, real scenes mostly use grids and stacks.
+	unsigned int side = (unsigned int)std::ceil(std::sqrt((double)bodyCount / 10.0));
+	std::string text = "material ice 0.1 0.05 0.1\nplane\n";
+	text.reserve(text.size() + (size_t)bodyCount * 40u);
+	char line[128];
+	for (unsigned int i = 0; i < bodyCount; i++)
+	{
+		unsigned int layer = i / (side * side);
+		unsigned int row = (i / side) % side;
+		unsigned int column = i % side;
+		snprintf(line, sizeof(line), "box %.1f %.1f %.1f 0.5 0.5 0.5 1 %s\n", column * 1.5f, 0.5f + layer * 1.5f, row * 1.5f, (i & 1u) ? "ice" : "default");
+		text += line;
+	}
+
+	const char* binaryPath = "scene_benchmark.scenebin";
+
+	auto parseStart = std::chrono::high_resolution_clock::now();
+	SceneDescription parsed;
+	bool parseSucceeded = parseSceneText(text, parsed, "<benchmark>");
+	auto parseEnd = std::chrono::high_resolution_clock::now();
+
+	bool saveSucceeded = parseSucceeded && saveSceneBinary(binaryPath, parsed);
+	auto saveEnd = std::chrono::high_resolution_clock::now();
+
+	SceneDescription loaded;
+	bool loadSucceeded = saveSucceeded && loadSceneDescription(binaryPath, loaded);
+	auto loadEnd = std::chrono::high_resolution_clock::now();
+	std::remove(binaryPath);
+
+	if (!loadSucceeded)
+	{
+		printf("ERROR: Scene load benchmark could not prepare its scene.\n");
+		return;
+	}
+
+	auto buildStart = std::chrono::high_resolution_clock::now();
+	world.buildScene(loaded);
+	auto buildEnd = std::chrono::high_resolution_clock::now();
+	world.step();
+	auto stepEnd = std::chrono::high_resolution_clock::now();
+	std::vector<SleepTransition> sleepTransitions;
+	world.getCollisionCallback().takeSleepTransitions(sleepTransitions);
+
+	auto milliseconds = [](std::chrono::high_resolution_clock::time_point begin, std::chrono::high_resolution_clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - begin).count();
+	};
+
+	printf("Scene load benchmark: %zu actors, %zu dynamic bodies, text %.1f MB\n", loaded.getActorCount(), world.getRigidbodyDynamic().size(), text.size() / (1024.0 * 1024.0));
+	printf("  text parse    : %.3f ms\n", milliseconds(parseStart, parseEnd));
+	printf("  binary save   : %.3f ms\n", milliseconds(parseEnd, saveEnd));
+	printf("  binary load   : %.3f ms\n", milliseconds(saveEnd, loadEnd));
+	printf("  build scene   : %.3f ms\n", milliseconds(buildStart, buildEnd));
+	printf("  first step    : %.3f ms\n", milliseconds(buildEnd, stepEnd));
+	printf("  binary total  : %.3f ms (load + build)\n", milliseconds(saveEnd, loadEnd) + milliseconds(buildStart, buildEnd));
+}
+
+void runSpawnBenchmark(unsigned int bodyCount, unsigned int workerCount)
+{
+	//Boxes start apart, so the first step measures broadphase insertion rather than contact solving.
+	unsigned int side = (unsigned int)std::ceil(std::cbrt((double)bodyCount));
+	SceneDescription description;
+	SceneElement plane = {};
+	plane.type = SceneElementType::Plane;
+	description.elements.push_back(plane);
+	SceneElement grid = {};
+	grid.type = SceneElementType::Grid;
+	grid.counts[0] = grid.counts[1] = grid.counts[2] = side;
+	grid.position[1] = 1.f;
+	grid.size[0] = grid.size[1] = grid.size[2] = 0.5f;
+	grid.spacing = 1.5f;
+	grid.density = 1.f;
+	description.elements.push_back(grid);
+
+	printf("Spawn benchmark: %u boxes\n", side * side * side);
+	printf("  shapes     | build ms | first step ms | heap MB | bytes/body | shape count\n");
+
+	//"integrated" is the spawn path before closed form masses and the registry, "exclusive" has closed forms only.
+	struct SpawnMode
+	{
+		const char* label;
+		bool shared;
+		bool integrated;
+	};
+	static const SpawnMode modes[] =
+	{
+		{ "integrated", false, true },
+		{ "exclusive", false, false },
+		{ "shared", true, false }
+	};
+
+	for (const SpawnMode& mode : modes)
+	{
+		PhysicsWorld world;
+		world.initialise(workerCount);
+		world.setShapeSharing(mode.shared);
+		world.setMassIntegration(mode.integrated);
+
+		size_t bytesBefore = world.getAllocatedBytes();
+		auto buildStart = std::chrono::high_resolution_clock::now();
+		world.buildScene(description);
+		auto buildEnd = std::chrono::high_resolution_clock::now();
+		size_t bytesAfter = world.getAllocatedBytes();
+		world.step();
+		auto stepEnd = std::chrono::high_resolution_clock::now();
+
+		std::vector<SleepTransition> sleepTransitions;
+		world.getCollisionCallback().takeSleepTransitions(sleepTransitions);
+
+		size_t bodies = world.getRigidbodyDynamic().size();
+		size_t bytes = bytesAfter - bytesBefore;
+		printf("  %-10s | %8.1f | %13.1f | %7.1f | %10.1f | %u\n", mode.label,
+			std::chrono::duration<double, std::milli>(buildEnd - buildStart).count(),
+			std::chrono::duration<double, std::milli>(stepEnd - buildEnd).count(),
+			bytes / (1024.0 * 1024.0), bodies > 0u ? (double)bytes / (double)bodies : 0.0, world.getPhysics()->getNbShapes());
+		world.release();
+	}
+}
+
+void runSceneConfigBenchmark(unsigned int stepCount, unsigned int stackSize, unsigned int workerCount, const SceneConfig& baseline)
+{
+	//Parallel walls, so the stacking scene has enough pairs to separate broadphases and solvers.
+	constexpr unsigned int wallCount = 8u;
+	SceneDescription description;
+	SceneElement plane = {};
+	plane.type = SceneElementType::Plane;
+	description.elements.push_back(plane);
+	for (unsigned int i = 0; i < wallCount; i++)
+	{
+		SceneElement wall = {};
+		wall.type = SceneElementType::Stack;
+		wall.counts[0] = wall.counts[1] = stackSize;
+		wall.position[1] = 1.f;
+		wall.position[2] = i * 6.f;
+		wall.size[0] = wall.size[1] = wall.size[2] = 1.f;
+		wall.density = 1.f;
+		description.elements.push_back(wall);
+	}
+
+	//The baseline, then one variant per option. Options are compared one at a time, not as a full product.
+	std::vector<SceneConfig> configs(1u, baseline);
+	for (physx::PxBroadPhaseType::Enum broadPhase : { physx::PxBroadPhaseType::eSAP, physx::PxBroadPhaseType::eMBP, physx::PxBroadPhaseType::eABP, physx::PxBroadPhaseType::ePABP })
+	{
+		if (broadPhase == baseline.broadPhase)
+			continue;
+		configs.push_back(baseline);
+		configs.back().broadPhase = broadPhase;
+	}
+	configs.push_back(baseline);
+	configs.back().solver = baseline.solver == physx::PxSolverType::ePGS ? physx::PxSolverType::eTGS : physx::PxSolverType::ePGS;
+	for (physx::PxFrictionType::Enum friction : { physx::PxFrictionType::ePATCH, physx::PxFrictionType::eONE_DIRECTIONAL, physx::PxFrictionType::eTWO_DIRECTIONAL })
+	{
+		if (friction == baseline.friction)
+			continue;
+		configs.push_back(baseline);
+		configs.back().friction = friction;
+	}
+	configs.push_back(baseline);
+	configs.back().pcm = !baseline.pcm;
+	configs.push_back(baseline);
+	configs.back().stabilization = !baseline.stabilization;
+	configs.push_back(baseline);
+	configs.back().ccd = !baseline.ccd;
+
+	printf("Scene config benchmark: %u steps, %u dynamic bodies, %u workers\n", stepCount, wallCount * stackSize * stackSize, workerCount);
+	printf("  %-28s | stack steps/sec | stack p99 ms | barrage steps/sec | barrage p99 ms\n", "config");
+
+	size_t fastestStack = 0u, fastestBarrage = 0u;
+	std::vector<double> stackRates, barrageRates;
+	for (const SceneConfig& config : configs)
+	{
+		StepStatistics stackStatistics;
+		{
+			PhysicsWorld world;
+			world.setSceneConfig(config);
+			world.initialise(workerCount);
+			world.buildScene(description);
+			stackStatistics = measureSteps(world, stepCount);
+			world.release();
+		}
+
+		//Four projectiles per step fired at the walls from behind the camera side, at most 256 alive.
+		StepStatistics barrageStatistics;
+		{
+			PhysicsWorld world;
+			world.setSceneConfig(config);
+			world.initialise(workerCount);
+			world.buildScene(description);
+
+			std::mt19937 random(12345u);
+			std::uniform_real_distribution<float> across(0.f, stackSize * 2.f);
+			//Ring of live projectiles, the oldest is released to make room for a new one.
+			std::vector<physx::PxRigidDynamic*> projectiles(256u, nullptr);
+			size_t nextProjectile = 0u;
+			barrageStatistics = measureSteps(world, stepCount, [&](unsigned int)
+			{
+				for (unsigned int i = 0; i < 4u; i++)
+				{
+					physx::PxRigidDynamic*& projectile = projectiles[nextProjectile];
+					nextProjectile = (nextProjectile + 1u) % projectiles.size();
+					if (projectile)
+						world.releaseDynamic(projectile);
+
+					physx::PxVec3 position(across(random), 1.f + across(random), -40.f);
+					projectile = world.createSphereProjectile(position, physx::PxVec3(0.f, 0.f, 80.f));
+					world.getScene()->addActor(*projectile);
+				}
+			});
+			world.release();
+		}
+
+		stackRates.push_back(stepsPerSecond(stackStatistics, stepCount));
+		barrageRates.push_back(stepsPerSecond(barrageStatistics, stepCount));
+		if (stackRates.back() > stackRates[fastestStack])
+			fastestStack = stackRates.size() - 1u;
+		if (barrageRates.back() > barrageRates[fastestBarrage])
+			fastestBarrage = barrageRates.size() - 1u;
+
+		printf("  %-28s | %15.1f | %12.3f | %17.1f | %14.3f\n", config.getName().c_str(),
+			stackRates.back(), stackStatistics.p99, barrageRates.back(), barrageStatistics.p99);
+	}
+
+	printf("  fastest stack  : %s (%.1f steps/sec)\n", configs[fastestStack].getName().c_str(), stackRates[fastestStack]);
+	printf("  fastest barrage: %s (%.1f steps/sec)\n", configs[fastestBarrage].getName().c_str(), barrageRates[fastestBarrage]);
+}
+
+void runSceneQueryBenchmark(physx::PxScene* scene, ThreadPool& pool, const physx::PxVec3& origin, const physx::PxVec3& front,
+	unsigned int rayCount, unsigned int iterationCount, float coneAngle)
+{
+	//Directions are uniform over the cone's solid angle, around an orthonormal basis of "front".
+	physx::PxVec3 axis = front.getNormalized();
+	physx::PxVec3 side = std::fabs(axis.y) < 0.99f ? axis.cross(physx::PxVec3(0.f, 1.f, 0.f)).getNormalized() : physx::PxVec3(1.f, 0.f, 0.f);
+	physx::PxVec3 up = side.cross(axis);
+
+	std::mt19937 random(12345u);
+	std::uniform_real_distribution<float> cosine(std::cos(glm::radians(coneAngle * 0.5f)), 1.f);
+	std::uniform_real_distribution<float> angle(0.f, physx::PxTwoPi);
+	std::vector<physx::PxVec3> directions(rayCount);
+	for (physx::PxVec3& direction : directions)
+	{
+		float cosTheta = cosine(random);
+		float sinTheta = std::sqrt(1.f - cosTheta * cosTheta);
+		float phi = angle(random);
+		direction = axis * cosTheta + (side * std::cos(phi) + up * std::sin(phi)) * sinTheta;
+	}
+
+	constexpr physx::PxReal rayLength = 1000.f;
+	SceneQueryService queryService(pool);
+	unsigned int batchHits = 0u;
+	auto batchStart = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0; i < iterationCount; i++)
+	{
+		for (const physx::PxVec3& direction : directions)
+			queryService.addRaycast(origin, direction, rayLength);
+		queryService.execute(scene);
+	}
+	auto batchEnd = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0; i < queryService.getRaycastCount(); i++)
+	{
+		if (queryService.getRaycastHit(i).actor)
+			batchHits++;
+	}
+
+	unsigned int serialHits = 0u;
+	auto serialStart = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0; i < iterationCount; i++)
+	{
+		serialHits = 0u;
+		for (const physx::PxVec3& direction : directions)
+		{
+			physx::PxRaycastBuffer hit;
+			if (scene->raycast(origin, direction, rayLength, hit) && hit.hasBlock)
+				serialHits++;
+		}
+	}
+	auto serialEnd = std::chrono::high_resolution_clock::now();
+
+	unsigned int iterations = iterationCount > 0u ? iterationCount : 1u;
+	double batchTime = std::chrono::duration<double, std::milli>(batchEnd - batchStart).count() / iterations;
+	double serialTime = std::chrono::duration<double, std::milli>(serialEnd - serialStart).count() / iterations;
+
+	printf("Scene query benchmark: %u rays, %.0f degree cone, %u iterations, %u workers\n", rayCount, coneAngle, iterationCount, pool.getWorkerCount());
+	printf("  batched       : %.3f ms (%.2f M rays/sec), %u hits\n", batchTime, batchTime > 0.0 ? rayCount / batchTime / 1000.0 : 0.0, batchHits);
+	printf("  serial        : %.3f ms (%.2f M rays/sec), %u hits\n", serialTime, serialTime > 0.0 ? rayCount / serialTime / 1000.0 : 0.0, serialHits);
+	printf("  results match : %s\n", batchHits == serialHits ? "yes" : "NO");
+}
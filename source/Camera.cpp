@@ -53,6 +53,11 @@ void Camera::setCameraPosition(glm::vec3 position)
 	cameraPosition = position;
 }
 
+void Camera::setCameraFront(glm::vec3 front)
+{
+	cameraFront = front;
+}
+
 void Camera::setCameraSpeed(float value)
 {
 	cameraSpeed = value;
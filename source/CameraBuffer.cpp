@@ -0,0 +1,39 @@
+#include "CameraBuffer.h"
+
+#include <cstring>
+
+//Matches the Camera block layout in main.vert and grid.vert.
+struct CameraBlock
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+};
+
+CameraBuffer::CameraBuffer() :
+	UBO(0u)
+{
+	glGenBuffers(1, &UBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, UBO);
+}
+
+void CameraBuffer::update(const glm::mat4& view, const glm::mat4& projection, StreamBuffer& stream)
+{
+	CameraBlock block = { view, projection };
+
+	StreamAllocation allocation = stream.allocate(sizeof(CameraBlock), stream.getUniformAlignment());
+	if (allocation.data)
+	{
+		std::memcpy(allocation.data, &block, sizeof(CameraBlock));
+		stream.bindRange(GL_UNIFORM_BUFFER, bindingPoint, allocation);
+		return;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &block);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, UBO);
+}
\ No newline at end of file
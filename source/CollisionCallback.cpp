@@ -1,41 +1,98 @@
 #include "CollisionCallback.h"
 
+CollisionCallback::CollisionCallback() :
+	events(eventCapacity),
+	droppedEventCount(0u),
+	truncatedContactCount(0u)
+{
+}
+
 void CollisionCallback::onTrigger(physx::PxTriggerPair* pairs, physx::PxU32 count)
 {
 	for (physx::PxU32 i = 0; i < count; i++)
 	{
-		const physx::PxTriggerPair pair = pairs[i];
+		const physx::PxTriggerPair& pair = pairs[i];
+		//Skip pairs whose shapes were deleted during simulation.
+		if (pair.flags & (physx::PxTriggerPairFlag::eREMOVED_SHAPE_TRIGGER | physx::PxTriggerPairFlag::eREMOVED_SHAPE_OTHER))
+			continue;
+
+		ContactEvent event = {};
+		event.actor0 = pair.triggerActor;
+		event.actor1 = pair.otherActor;
 		if (pair.status & physx::PxPairFlag::eNOTIFY_TOUCH_FOUND)
-		{
-			std::cout << "Something entered trigger volume. Teleporting!\n";
-			physx::PxActor* actor = pair.otherActor;
-			physx::PxRigidDynamic* dynamic = actor->is<physx::PxRigidDynamic>();
-			if (dynamic)
-			{
-				const physx::PxVec3 teleportPosition = physx::PxVec3(0.f, 15.f, 15.f);
-				const physx::PxTransform transform = physx::PxTransform(teleportPosition);
-				//dynamic->setGlobalPose(transform);
-			}
-		}
+			event.type = ContactEventType::TriggerEnter;
+		else if (pair.status & physx::PxPairFlag::eNOTIFY_TOUCH_LOST)
+			event.type = ContactEventType::TriggerExit;
+		else
+			continue;
+
+		pushEvent(event);
 	}
 }
 
 void CollisionCallback::onContact(const physx::PxContactPairHeader& pairHeader, const physx::PxContactPair* pairs, physx::PxU32 nbPairs)
 {
-	for (size_t i = 0; i < nbPairs; i++)
+	if (pairHeader.flags & (physx::PxContactPairHeaderFlag::eREMOVED_ACTOR_0 | physx::PxContactPairHeaderFlag::eREMOVED_ACTOR_1))
+		return;
+
+	for (physx::PxU32 i = 0; i < nbPairs; i++)
 	{
 		const physx::PxContactPair* curContactPair = &pairs[i];
-		
-		const unsigned int contactPointCount = curContactPair->contactCount;
-		physx::PxContactPairPoint* contactPoints = new physx::PxContactPairPoint[contactPointCount];
-		curContactPair->extractContacts(contactPoints, contactPointCount);
 
-		for (size_t j = 0; j < contactPointCount; j++)
+		const physx::PxU32 contactPointCount = curContactPair->contactCount;
+		if (contactPointCount > maxContactPointsPerPair)
+			truncatedContactCount.fetch_add(contactPointCount - maxContactPointsPerPair, std::memory_order_relaxed);
+
+		const physx::PxU32 extracted = curContactPair->extractContacts(contactScratch, maxContactPointsPerPair);
+		for (physx::PxU32 j = 0; j < extracted; j++)
 		{
-			physx::PxVec3 pos = contactPoints[j].position;
-			std::cout << "Contact occured at global pos: " << pos.x << " " << pos.y << " " << pos.z << std::endl;
+			ContactEvent event;
+			event.actor0 = pairHeader.actors[0];
+			event.actor1 = pairHeader.actors[1];
+			event.position = contactScratch[j].position;
+			event.impulse = contactScratch[j].impulse;
+			event.normal = contactScratch[j].normal;
+			event.type = ContactEventType::Contact;
+			pushEvent(event);
 		}
-
-		delete[] contactPoints;
 	}
 }
+
+bool CollisionCallback::popEvent(ContactEvent& event)
+{
+	return events.pop(event);
+}
+
+unsigned long long CollisionCallback::getDroppedEventCount() const
+{
+	return droppedEventCount.load(std::memory_order_relaxed);
+}
+
+unsigned long long CollisionCallback::getTruncatedContactCount() const
+{
+	return truncatedContactCount.load(std::memory_order_relaxed);
+}
+
+void CollisionCallback::onWake(physx::PxActor** actors, physx::PxU32 count)
+{
+	for (physx::PxU32 i = 0; i < count; i++)
+		sleepTransitions.push_back({ actors[i], false });
+}
+
+void CollisionCallback::onSleep(physx::PxActor** actors, physx::PxU32 count)
+{
+	for (physx::PxU32 i = 0; i < count; i++)
+		sleepTransitions.push_back({ actors[i], true });
+}
+
+void CollisionCallback::takeSleepTransitions(std::vector<SleepTransition>& transitions)
+{
+	transitions.clear();
+	transitions.swap(sleepTransitions);
+}
+
+void CollisionCallback::pushEvent(const ContactEvent& event)
+{
+	if (!events.push(event))
+		droppedEventCount.fetch_add(1u, std::memory_order_relaxed);
+}
@@ -11,6 +11,8 @@ physx::PxFilterFlags customFilterShader(physx::PxFilterObjectAttributes attribut
 	pairFlags = physx::PxPairFlag::eCONTACT_DEFAULT;
 	pairFlags |= physx::PxPairFlag::eNOTIFY_TOUCH_FOUND;
 	pairFlags |= physx::PxPairFlag::eNOTIFY_CONTACT_POINTS;
+	//Only has an effect when the scene enables CCD and one of the bodies has PxRigidBodyFlag::eENABLE_CCD.
+	pairFlags |= physx::PxPairFlag::eDETECT_CCD_CONTACT;
 
 	return physx::PxFilterFlag::eDEFAULT;
 }
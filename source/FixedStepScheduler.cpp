@@ -0,0 +1,61 @@
+#include "FixedStepScheduler.h"
+
+#include <cmath>
+
+FixedStepScheduler::FixedStepScheduler(double fixedStepSize, unsigned int maxSubstepCount) :
+	stepSize(fixedStepSize),
+	accumulator(0.0),
+	maxSubsteps(maxSubstepCount),
+	stepIndex(0u),
+	droppedFrameCount(0u)
+{
+}
+
+unsigned int FixedStepScheduler::advance(double frameTime)
+{
+	//Negative time can only come from a clock reset, ignore it.
+	if (frameTime > 0.0)
+		accumulator += frameTime;
+
+	unsigned int steps = (unsigned int)std::floor(accumulator / stepSize);
+	if (steps > maxSubsteps)
+	{
+		//Simulation cannot keep up. Run the cap and keep only the fractional part so the next frame starts fresh.
+		steps = maxSubsteps;
+		accumulator = std::fmod(accumulator, stepSize);
+		droppedFrameCount++;
+	}
+	else
+	{
+		accumulator -= steps * stepSize;
+	}
+
+	stepIndex += steps;
+	return steps;
+}
+
+float FixedStepScheduler::getAlpha() const
+{
+	float alpha = (float)(accumulator / stepSize);
+	return alpha < 0.f ? 0.f : (alpha >= 1.f ? 0.999999f : alpha);
+}
+
+unsigned long long FixedStepScheduler::getStepIndex() const
+{
+	return stepIndex;
+}
+
+unsigned long long FixedStepScheduler::getDroppedFrameCount() const
+{
+	return droppedFrameCount;
+}
+
+double FixedStepScheduler::getStepSize() const
+{
+	return stepSize;
+}
+
+void FixedStepScheduler::setMaxSubsteps(unsigned int value)
+{
+	maxSubsteps = value;
+}
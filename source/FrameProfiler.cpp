@@ -0,0 +1,248 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+//Zone 0 is the whole frame, recorded by endFrame().
+static const char* const frameZoneName = "frame";
+
+//Returns min, average and 99th percentile of the non negative samples. False when there are none.
+static bool summarize(const std::vector<float>& totals, float& minimum, float& average, float& p99)
+{
+	std::vector<float> samples;
+	samples.reserve(totals.size());
+	for (float total : totals)
+	{
+		if (total >= 0.f)
+			samples.push_back(total);
+	}
+	if (samples.empty())
+		return false;
+
+	std::sort(samples.begin(), samples.end());
+	double sum = 0.0;
+	for (float sample : samples)
+		sum += sample;
+
+	minimum = samples.front();
+	average = (float)(sum / samples.size());
+	p99 = samples[std::min((size_t)(0.99 * (samples.size() - 1) + 0.5), samples.size() - 1)];
+	return true;
+}
+
+FrameProfiler::FrameProfiler(unsigned int historyLength) :
+	epoch(std::chrono::high_resolution_clock::now()),
+	history(historyLength > gpuLatency ? historyLength : gpuLatency + 1u),
+	frameIndex(0u),
+	frameStart(0.0),
+	gpuZoneOpen(false),
+	droppedGpuSampleCount(0u)
+{
+	frames.resize(history);
+	for (FrameRecord& record : frames)
+		record.frameIndex = ~0ull;
+
+	for (QuerySlot& slot : querySlots)
+	{
+		glGenQueries(maxGpuZonesPerFrame, slot.queries);
+		slot.frameIndex = 0u;
+		slot.pendingCount = 0u;
+	}
+
+	getZoneIndex(frameZoneName);
+}
+
+void FrameProfiler::release()
+{
+	for (QuerySlot& slot : querySlots)
+	{
+		if (slot.queries[0] == 0u)
+			continue;
+
+		glDeleteQueries(maxGpuZonesPerFrame, slot.queries);
+		for (unsigned int& query : slot.queries)
+			query = 0u;
+		slot.pendingCount = 0u;
+	}
+}
+
+void FrameProfiler::beginFrame()
+{
+	//The slot was last used gpuLatency frames ago, its results are normally available by now.
+	QuerySlot& slot = querySlots[frameIndex % gpuLatency];
+	collectGpuResults(slot);
+	slot.frameIndex = frameIndex;
+
+	unsigned int index = (unsigned int)(frameIndex % history);
+	FrameRecord& record = frames[index];
+	record.frameIndex = frameIndex;
+	record.cpuEvents.clear();
+	record.gpuEvents.clear();
+	for (ZoneStatistics& statistics : zones)
+	{
+		statistics.cpuTotals[index] = -1.f;
+		statistics.gpuTotals[index] = -1.f;
+	}
+
+	openZones.clear();
+	frameStart = now();
+}
+
+void FrameProfiler::endFrame()
+{
+	unsigned int index = (unsigned int)(frameIndex % history);
+	double duration = now() - frameStart;
+	frames[index].cpuEvents.push_back({ 0u, 0u, frameStart, duration });
+	zones[0].cpuTotals[index] = (float)duration;
+
+	frameIndex++;
+}
+
+void FrameProfiler::beginZone(const char* name, bool gpu)
+{
+	OpenZone zone = { getZoneIndex(name), now(), false };
+
+	QuerySlot& slot = querySlots[frameIndex % gpuLatency];
+	if (gpu && !gpuZoneOpen && slot.pendingCount < maxGpuZonesPerFrame)
+	{
+		slot.pending[slot.pendingCount] = { zone.zone, (unsigned int)openZones.size() + 1u, zone.start };
+		glBeginQuery(GL_TIME_ELAPSED, slot.queries[slot.pendingCount]);
+		gpuZoneOpen = true;
+		zone.gpu = true;
+	}
+
+	openZones.push_back(zone);
+}
+
+void FrameProfiler::endZone()
+{
+	if (openZones.empty())
+		return;
+
+	OpenZone zone = openZones.back();
+	openZones.pop_back();
+
+	if (zone.gpu)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		querySlots[frameIndex % gpuLatency].pendingCount++;
+		gpuZoneOpen = false;
+	}
+
+	unsigned int index = (unsigned int)(frameIndex % history);
+	double duration = now() - zone.start;
+	frames[index].cpuEvents.push_back({ zone.zone, (unsigned int)openZones.size() + 1u, zone.start, duration });
+
+	float& total = zones[zone.zone].cpuTotals[index];
+	total = (total < 0.f ? 0.f : total) + (float)duration;
+}
+
+void FrameProfiler::printReport() const
+{
+	printf("Frame profile: last %u frames, %llu GPU samples dropped\n", history, droppedGpuSampleCount);
+	printf("  %-24s | cpu min ms | cpu avg ms | cpu p99 ms | gpu min ms | gpu avg ms | gpu p99 ms\n", "zone");
+
+	for (const ZoneStatistics& statistics : zones)
+	{
+		float minimum, average, p99;
+		printf("  %-24s", statistics.name);
+		if (summarize(statistics.cpuTotals, minimum, average, p99))
+			printf(" | %10.3f | %10.3f | %10.3f", minimum, average, p99);
+		else
+			printf(" | %10s | %10s | %10s", "-", "-", "-");
+		if (summarize(statistics.gpuTotals, minimum, average, p99))
+			printf(" | %10.3f | %10.3f | %10.3f\n", minimum, average, p99);
+		else
+			printf(" | %10s | %10s | %10s\n", "-", "-", "-");
+	}
+}
+
+bool FrameProfiler::writeChromeTrace(const std::string& path) const
+{
+	FILE* file = std::fopen(path.c_str(), "w");
+	if (!file)
+	{
+		printf("ERROR: Trace file could not be written: %s\n", path.c_str());
+		return false;
+	}
+
+	//GPU events have no GPU clock reference, they are placed at the CPU time their zone was opened.
+	std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Render thread\"}},\n");
+	std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+
+	//Oldest frame first. Only completed frames are written.
+	unsigned long long firstFrame = frameIndex > history ? frameIndex - history : 0u;
+	for (unsigned long long frame = firstFrame; frame < frameIndex; frame++)
+	{
+		const FrameRecord& record = frames[frame % history];
+		if (record.frameIndex != frame)
+			continue;
+
+		for (int track = 1; track <= 2; track++)
+		{
+			for (const ZoneEvent& event : track == 1 ? record.cpuEvents : record.gpuEvents)
+			{
+				std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+					zones[event.zone].name, track == 1 ? "cpu" : "gpu", track, event.start * 1000.0, event.duration * 1000.0, frame);
+			}
+		}
+	}
+
+	std::fprintf(file, "\n]}\n");
+	bool written = std::ferror(file) == 0;
+	std::fclose(file);
+	return written;
+}
+
+unsigned long long FrameProfiler::getDroppedGpuSampleCount() const
+{
+	return droppedGpuSampleCount;
+}
+
+double FrameProfiler::now() const
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - epoch).count();
+}
+
+unsigned int FrameProfiler::getZoneIndex(const char* name)
+{
+	auto found = zoneIndices.find(name);
+	if (found != zoneIndices.end())
+		return found->second;
+
+	unsigned int index = (unsigned int)zones.size();
+	zones.push_back({ name, std::vector<float>(history, -1.f), std::vector<float>(history, -1.f) });
+	zoneIndices.emplace(name, index);
+	return index;
+}
+
+void FrameProfiler::collectGpuResults(QuerySlot& slot)
+{
+	unsigned int index = (unsigned int)(slot.frameIndex % history);
+	FrameRecord& record = frames[index];
+
+	for (unsigned int i = 0; i < slot.pendingCount; i++)
+	{
+		GLint available = 0;
+		glGetQueryObjectiv(slot.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+		{
+			droppedGpuSampleCount++;
+			continue;
+		}
+
+		GLuint64 elapsed = 0u;
+		glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT, &elapsed);
+		if (record.frameIndex != slot.frameIndex)
+			continue;
+
+		const PendingQuery& pending = slot.pending[i];
+		double duration = (double)elapsed / 1000000.0;
+		record.gpuEvents.push_back({ pending.zone, pending.depth, pending.cpuStart, duration });
+		float& total = zones[pending.zone].gpuTotals[index];
+		total = (total < 0.f ? 0.f : total) + (float)duration;
+	}
+
+	slot.pendingCount = 0u;
+}
@@ -0,0 +1,194 @@
+#include "FrustumCuller.h"
+
+#include <cmath>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRUSTUM_CULLER_SSE 1
+#include <emmintrin.h>
+#endif
+
+BoundsSoA::BoundsSoA() :
+	count(0u)
+{
+}
+
+void BoundsSoA::push(const physx::PxBounds3& bounds)
+{
+	count++;
+	pad();
+	set(count - 1u, bounds);
+}
+
+void BoundsSoA::set(unsigned int index, const physx::PxBounds3& bounds)
+{
+	components[0][index] = bounds.minimum.x;
+	components[1][index] = bounds.minimum.y;
+	components[2][index] = bounds.minimum.z;
+	components[3][index] = bounds.maximum.x;
+	components[4][index] = bounds.maximum.y;
+	components[5][index] = bounds.maximum.z;
+}
+
+physx::PxBounds3 BoundsSoA::get(unsigned int index) const
+{
+	return physx::PxBounds3(
+		physx::PxVec3(components[0][index], components[1][index], components[2][index]),
+		physx::PxVec3(components[3][index], components[4][index], components[5][index]));
+}
+
+void BoundsSoA::swapRemove(unsigned int index)
+{
+	unsigned int last = count - 1u;
+	if (index != last)
+		set(index, get(last));
+
+	//Padding lanes must stay empty boxes.
+	for (unsigned int axis = 0; axis < 6; axis++)
+		components[axis][last] = padValue(axis);
+	count--;
+	pad();
+}
+
+void BoundsSoA::clear()
+{
+	count = 0u;
+	pad();
+}
+
+unsigned int BoundsSoA::size() const
+{
+	return count;
+}
+
+const float* BoundsSoA::component(unsigned int axis) const
+{
+	return components[axis].data();
+}
+
+void BoundsSoA::pad()
+{
+	size_t paddedSize = ((size_t)count + 3u) & ~size_t(3u);
+	for (unsigned int axis = 0; axis < 6; axis++)
+		components[axis].resize(paddedSize, padValue(axis));
+}
+
+float BoundsSoA::padValue(unsigned int axis)
+{
+	//Empty boxes have minimum > maximum and fail every plane test.
+	return axis < 3 ? std::numeric_limits<float>::max() : -std::numeric_limits<float>::max();
+}
+
+FrustumCuller::FrustumCuller() :
+	planes{},
+	visibleCount(0u),
+	totalCount(0u)
+{
+}
+
+void FrustumCuller::setViewProjection(const glm::mat4& viewProjection)
+{
+	//glm is column major, row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i]).
+	for (unsigned int plane = 0; plane < 6; plane++)
+	{
+		unsigned int row = plane / 2u;
+		float sign = (plane % 2u == 0u) ? 1.f : -1.f;
+		for (unsigned int column = 0; column < 4; column++)
+			planes[plane][column] = viewProjection[column][3] + sign * viewProjection[column][row];
+
+		float length = std::sqrt(planes[plane][0] * planes[plane][0] + planes[plane][1] * planes[plane][1] + planes[plane][2] * planes[plane][2]);
+		if (length > 0.f)
+		{
+			for (unsigned int column = 0; column < 4; column++)
+				planes[plane][column] /= length;
+		}
+	}
+}
+
+unsigned int FrustumCuller::cull(const BoundsSoA& bounds, std::vector<unsigned int>& visible)
+{
+	unsigned int count = bounds.size();
+	unsigned int found = 0u;
+
+#ifdef FRUSTUM_CULLER_SSE
+	//The plane normal is shared by all 4 lanes, so the corner furthest along it (positive vertex) is picked
+	//per plane by choosing the minimum or maximum array once, not per box.
+	const float* positive[6][3];
+	for (unsigned int plane = 0; plane < 6; plane++)
+	{
+		for (unsigned int axis = 0; axis < 3; axis++)
+			positive[plane][axis] = bounds.component(planes[plane][axis] >= 0.f ? axis + 3u : axis);
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+	for (unsigned int base = 0; base < count; base += 4u)
+	{
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (unsigned int plane = 0; plane < 6; plane++)
+		{
+			__m128 distance = _mm_set1_ps(planes[plane][3]);
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_loadu_ps(positive[plane][0] + base), _mm_set1_ps(planes[plane][0])));
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_loadu_ps(positive[plane][1] + base), _mm_set1_ps(planes[plane][1])));
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_loadu_ps(positive[plane][2] + base), _mm_set1_ps(planes[plane][2])));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		for (unsigned int lane = 0; mask != 0; lane++, mask >>= 1)
+		{
+			if ((mask & 1) && base + lane < count)
+			{
+				visible.push_back(base + lane);
+				found++;
+			}
+		}
+	}
+#else
+	found = cullScalar(bounds, visible);
+#endif
+
+	visibleCount += found;
+	totalCount += count;
+	return found;
+}
+
+unsigned int FrustumCuller::cullScalar(const BoundsSoA& bounds, std::vector<unsigned int>& visible) const
+{
+	unsigned int count = bounds.size();
+	unsigned int found = 0u;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		bool inside = true;
+		for (unsigned int plane = 0; plane < 6 && inside; plane++)
+		{
+			float distance = planes[plane][3];
+			for (unsigned int axis = 0; axis < 3; axis++)
+				distance += planes[plane][axis] * bounds.component(planes[plane][axis] >= 0.f ? axis + 3u : axis)[i];
+			inside = distance >= 0.f;
+		}
+
+		if (inside)
+		{
+			visible.push_back(i);
+			found++;
+		}
+	}
+
+	return found;
+}
+
+void FrustumCuller::resetCounters()
+{
+	visibleCount = 0u;
+	totalCount = 0u;
+}
+
+unsigned int FrustumCuller::getVisibleCount() const
+{
+	return visibleCount;
+}
+
+unsigned int FrustumCuller::getTotalCount() const
+{
+	return totalCount;
+}
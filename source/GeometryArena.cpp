@@ -0,0 +1,154 @@
+#include "GeometryArena.h"
+
+#include <vector>
+
+//Vertex buffer binding index used by every attribute.
+static constexpr GLuint vertexBinding = 0u;
+
+GeometryArena::GeometryArena(unsigned int attributes, unsigned int initialVertexCapacity, unsigned int initialIndexCapacity) :
+	layout(VertexLayout::build(attributes)),
+	VAO(0u),
+	VBO(0u),
+	EBO(0u),
+	vertexCount(0u),
+	indexCount(0u),
+	vertexCapacity(initialVertexCapacity),
+	indexCapacity(initialIndexCapacity)
+{
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertexCapacity * layout.stride, nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indexCapacity * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	//Separate attribute formats, so growing only has to rebind the vertex buffer. Locations match Mesh.
+	glBindVertexArray(VAO);
+	glEnableVertexAttribArray(0);
+	glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, 0);
+	glVertexAttribBinding(0, vertexBinding);
+	if (layout.has(VERTEX_NORMAL))
+	{
+		glEnableVertexAttribArray(1);
+		glVertexAttribFormat(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, (GLuint)layout.normalOffset);
+		glVertexAttribBinding(1, vertexBinding);
+	}
+	if (layout.has(VERTEX_TEXCOORDS))
+	{
+		glEnableVertexAttribArray(2);
+		glVertexAttribFormat(2, 2, GL_HALF_FLOAT, GL_FALSE, (GLuint)layout.texCoordsOffset);
+		glVertexAttribBinding(2, vertexBinding);
+	}
+	if (layout.has(VERTEX_TANGENT))
+	{
+		glEnableVertexAttribArray(3);
+		glVertexAttribFormat(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, (GLuint)layout.tangentOffset);
+		glVertexAttribBinding(3, vertexBinding);
+	}
+	if (layout.has(VERTEX_BONES))
+	{
+		glEnableVertexAttribArray(5);
+		glVertexAttribIFormat(5, 4, GL_INT, (GLuint)layout.boneIdsOffset);
+		glVertexAttribBinding(5, vertexBinding);
+		glEnableVertexAttribArray(6);
+		glVertexAttribFormat(6, 4, GL_FLOAT, GL_FALSE, (GLuint)layout.weightsOffset);
+		glVertexAttribBinding(6, vertexBinding);
+	}
+	glBindVertexBuffer(vertexBinding, VBO, 0, layout.stride);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBindVertexArray(0);
+}
+
+ArenaRange GeometryArena::add(const Vertex* vertexData, unsigned int meshVertexCount, const unsigned int* indexData, unsigned int meshIndexCount)
+{
+	bool grown = false;
+	if (vertexCount + meshVertexCount > vertexCapacity)
+	{
+		unsigned int capacity = vertexCapacity * 2u;
+		while (capacity < vertexCount + meshVertexCount)
+			capacity *= 2u;
+		growBuffer(VBO, (size_t)vertexCount * layout.stride, (size_t)capacity * layout.stride);
+		vertexCapacity = capacity;
+		grown = true;
+	}
+	if (indexCount + meshIndexCount > indexCapacity)
+	{
+		unsigned int capacity = indexCapacity * 2u;
+		while (capacity < indexCount + meshIndexCount)
+			capacity *= 2u;
+		growBuffer(EBO, (size_t)indexCount * sizeof(unsigned int), (size_t)capacity * sizeof(unsigned int));
+		indexCapacity = capacity;
+		grown = true;
+	}
+	if (grown)
+	{
+		glBindVertexArray(VAO);
+		glBindVertexBuffer(vertexBinding, VBO, 0, layout.stride);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glBindVertexArray(0);
+	}
+
+	std::vector<unsigned char> packed((size_t)meshVertexCount * layout.stride);
+	layout.pack(vertexData, meshVertexCount, packed.data());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)vertexCount * layout.stride, (GLsizeiptr)packed.size(), packed.data());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)indexCount * sizeof(unsigned int), (GLsizeiptr)meshIndexCount * sizeof(unsigned int), indexData);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	ArenaRange range = { indexCount, meshIndexCount, vertexCount };
+	vertexCount += meshVertexCount;
+	indexCount += meshIndexCount;
+	return range;
+}
+
+void GeometryArena::bind() const
+{
+	glBindVertexArray(VAO);
+}
+
+void GeometryArena::release()
+{
+	if (VAO == 0u)
+		return;
+
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	VAO = VBO = EBO = 0u;
+}
+
+unsigned int GeometryArena::getAttributes() const
+{
+	return layout.attributes;
+}
+
+unsigned int GeometryArena::getVertexCount() const
+{
+	return vertexCount;
+}
+
+unsigned int GeometryArena::getIndexCount() const
+{
+	return indexCount;
+}
+
+void GeometryArena::growBuffer(unsigned int& buffer, size_t usedBytes, size_t newBytes)
+{
+	unsigned int grownBuffer = 0u;
+	glGenBuffers(1, &grownBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, grownBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)newBytes, nullptr, GL_STATIC_DRAW);
+	if (usedBytes > 0u)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)usedBytes);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glDeleteBuffers(1, &buffer);
+	buffer = grownBuffer;
+}
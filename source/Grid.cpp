@@ -9,13 +9,15 @@ void Grid::draw(Shader& shader)
 {
 	glBindVertexArray(VAO);
 
-	glUniform3f(glGetUniformLocation(shader.ID, "color"), 1.f, 0.f, 0.f);
+	const int colorLocation = shader.getUniformLocation("color");
+
+	shader.setVec3(colorLocation, 1.f, 0.f, 0.f);
 	glDrawArrays(GL_LINES, 0, 2);
 
-	glUniform3f(glGetUniformLocation(shader.ID, "color"), 0.f, 1.f, 0.f);
+	shader.setVec3(colorLocation, 0.f, 1.f, 0.f);
 	glDrawArrays(GL_LINES, 2, 2);
 
-	glUniform3f(glGetUniformLocation(shader.ID, "color"), 0.f, 0.f, 1.f);
+	shader.setVec3(colorLocation, 0.f, 0.f, 1.f);
 	glDrawArrays(GL_LINES, 4, 2);
 }
 
@@ -0,0 +1,127 @@
+#include "InputLog.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "PhysicsWorld.h"
+
+struct InputLogHeader
+{
+	char magic[4];
+	uint32_t version;
+	double stepSize;
+	char sceneSource[240];
+};
+
+static const char inputLogMagic[4] = { 'P', 'X', 'I', 'N' };
+static constexpr uint32_t inputLogVersion = 1u;
+
+InputRecorder::InputRecorder() :
+	frameCount(0u)
+{
+}
+
+InputRecorder::~InputRecorder()
+{
+	close();
+}
+
+bool InputRecorder::open(const std::string& path, const std::string& sceneSource)
+{
+	close();
+
+	stream.open(path, std::ios::binary | std::ios::trunc);
+	if (!stream)
+	{
+		printf("ERROR: Input log could not be written: %s\n", path.c_str());
+		return false;
+	}
+
+	InputLogHeader header = {};
+	std::memcpy(header.magic, inputLogMagic, sizeof(inputLogMagic));
+	header.version = inputLogVersion;
+	header.stepSize = pPhysicsStepSize;
+	std::strncpy(header.sceneSource, sceneSource.c_str(), sizeof(header.sceneSource) - 1u);
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	frameCount = 0u;
+
+	return (bool)stream;
+}
+
+void InputRecorder::record(const InputFrame& frame)
+{
+	//ofstream buffers internally, a frame is only a few dozen bytes.
+	stream.write(reinterpret_cast<const char*>(&frame), sizeof(frame));
+	frameCount++;
+}
+
+void InputRecorder::close()
+{
+	if (stream.is_open())
+		stream.close();
+}
+
+bool InputRecorder::isOpen() const
+{
+	return stream.is_open();
+}
+
+uint64_t InputRecorder::getFrameCount() const
+{
+	return frameCount;
+}
+
+InputReplay::InputReplay() :
+	frames(nullptr),
+	frameCount(0u)
+{
+}
+
+bool InputReplay::open(const std::string& path)
+{
+	frames = nullptr;
+	frameCount = 0u;
+
+	if (!file.open(path))
+	{
+		printf("ERROR: Input log could not be opened: %s\n", path.c_str());
+		return false;
+	}
+
+	const InputLogHeader* header = reinterpret_cast<const InputLogHeader*>(file.data());
+	if (file.size() < sizeof(InputLogHeader) || std::memcmp(header->magic, inputLogMagic, sizeof(inputLogMagic)) != 0 || header->version != inputLogVersion)
+	{
+		printf("ERROR: %s is not a version %u input log.\n", path.c_str(), inputLogVersion);
+		file.close();
+		return false;
+	}
+
+	if (header->stepSize != pPhysicsStepSize)
+		printf("WARNING: Input log was recorded with a step of %f s, replay uses %f s.\n", header->stepSize, pPhysicsStepSize);
+
+	//A trailing partial frame from an interrupted recording is ignored.
+	frames = reinterpret_cast<const InputFrame*>(file.data() + sizeof(InputLogHeader));
+	frameCount = (file.size() - sizeof(InputLogHeader)) / sizeof(InputFrame);
+	return true;
+}
+
+uint64_t InputReplay::getFrameCount() const
+{
+	return frameCount;
+}
+
+const InputFrame& InputReplay::getFrame(uint64_t index) const
+{
+	return frames[index];
+}
+
+std::string InputReplay::getSceneSource() const
+{
+	const InputLogHeader* header = reinterpret_cast<const InputLogHeader*>(file.data());
+	return std::string(header->sceneSource, strnlen(header->sceneSource, sizeof(header->sceneSource)));
+}
+
+double InputReplay::getStepSize() const
+{
+	return reinterpret_cast<const InputLogHeader*>(file.data())->stepSize;
+}
@@ -1,4 +1,7 @@
 #include <iostream>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
 
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
@@ -7,121 +10,239 @@
 
 #include "Shader.h"
 #include "Model.h"
+#include "GeometryArena.h"
+#include "TextureArray.h"
 #include "Camera.h"
 #include "Callback.h"
 #include "Utilities.h"
 #include "Grid.h"
-
-#include "CollisionCallback.h"
-#include "FilterShader.h"
+#include "CameraBuffer.h"
+#include "StreamBuffer.h"
+#include "TransformBuffer.h"
+#include "TransformCache.h"
+#include "FixedStepScheduler.h"
+#include "ProjectilePool.h"
+
+#include "PhysicsWorld.h"
+#include "SceneConfig.h"
+#include "Benchmark.h"
+#include "ThreadPool.h"
+#include "PoolCpuDispatcher.h"
+#include "SceneQueryService.h"
+#include "AsyncTextureLoader.h"
+#include "TextureCache.h"
+#include "FrustumCuller.h"
+#include "InputLog.h"
+#include "FrameProfiler.h"
 
 float deltaTime = 0.0, currentFrame, lastFrame = 0.f;
 float diffTime = 0.0, currentTime, lastTime = 0.f;
 int fpsToShow = 0;
 unsigned long long counter = 0;
 
-// GLOBAL PHYSICS VARIABLES.
-static physx::PxDefaultAllocator pAllocator;
-static physx::PxDefaultErrorCallback pError;
+bool pPhysicsStart = false;
+constexpr float pPhysicsDeleteThreshold = 1000.f;
 
-static physx::PxFoundation* pFoundation = nullptr;
-static physx::PxPhysics* pPhysics = nullptr;
+physx::PxRigidDynamic* createSphereProjectileFromCamera(ProjectilePool& pool, TransformCache& cache, glm::vec3 viewPos, glm::vec3 viewFront);
+glm::mat4 getGlmTransformMatrixFromPhysX(physx::PxTransform t);
+glm::mat4 getStaticModelMatrix(physx::PxRigidStatic* actor);
+unsigned int drainContactEvents(CollisionCallback& callback);
+void settleWorld(PhysicsWorld& world, unsigned int maxStepCount);
+void collectDistantBodies(TransformCache& cache, glm::vec3 viewPos, std::vector<physx::PxRigidDynamic*>& pendingRelease);
+void runHeadlessReplay(PhysicsWorld& world, const InputReplay& replay);
+bool hasOption(int argc, char** argv, const char* name);
+const char* getOptionValue(int argc, char** argv, const char* name);
+unsigned int getPositionalArgument(int argc, char** argv, int index, unsigned int defaultValue);
+bool getSceneConfig(int argc, char** argv, SceneConfig& config);
+
+int main(int argc, char** argv)
+{
+    //Worker threads shared by PhysX and render side jobs. "--workers N" overrides the count, "--pin" pins worker i to core i.
+    const char* workersOption = getOptionValue(argc, argv, "--workers");
+    unsigned int workerCount = workersOption ? (unsigned int)std::strtoul(workersOption, nullptr, 10) : ThreadPool::getDefaultWorkerCount();
+    bool pinWorkers = hasOption(argc, argv, "--pin");
+
+    //Scene options: "--broadphase sap|mbp|abp|pabp", "--solver pgs|tgs", "--friction patch|one|two",
+    //"--pcm" or "--no-pcm", "--stabilization" and "--ccd". Omitted options keep PhysX's defaults.
+    SceneConfig sceneConfig;
+    if (!getSceneConfig(argc, argv, sceneConfig))
+        return EXIT_FAILURE;
+
+    //"--physx-profile path" forwards PhysX's internal zones to PhysXProfiler and writes per step histograms to "path".
+    //The callback is global to the SDK, so it is registered before any foundation is created and cleared after the last one.
+    const char* physxProfilePath = getOptionValue(argc, argv, "--physx-profile");
+    PhysXProfiler physxProfiler;
+    if (physxProfilePath)
+        physx::PxSetProfilerCallback(&physxProfiler);
+
+    //Scaling mode: "--scaling [steps] [stack size]" compares ThreadPool against PxDefaultCpuDispatcher for 1..workers threads.
+    if (argc > 1 && std::strcmp(argv[1], "--scaling") == 0)
+    {
+        unsigned int stepCount = getPositionalArgument(argc, argv, 2, 300u);
+        unsigned int stackSize = getPositionalArgument(argc, argv, 3, 30u);
+
+        if (physxProfilePath)
+            runDispatcherScalingBenchmark(stepCount, stackSize, workerCount, pinWorkers, &physxProfiler, physxProfilePath);
+        else
+            runDispatcherScalingBenchmark(stepCount, stackSize, workerCount, pinWorkers);
+        physx::PxSetProfilerCallback(nullptr);
+        return EXIT_SUCCESS;
+    }
 
-physx::PxMaterial* pMaterial = nullptr;
+    //Culling mode: "--cull-benchmark [bodies] [iterations]" compares SSE and scalar frustum tests on random boxes.
+    if (argc > 1 && std::strcmp(argv[1], "--cull-benchmark") == 0)
+    {
+        unsigned int bodyCount = getPositionalArgument(argc, argv, 2, 100000u);
+        unsigned int iterationCount = getPositionalArgument(argc, argv, 3, 200u);
 
-bool pPhysicsStart = false;
-constexpr float pPhysicsDeleteThreshold = 1000.f;
+        runCullingBenchmark(bodyCount, iterationCount);
+        return EXIT_SUCCESS;
+    }
 
-CollisionCallback collisionCallback;
+    //Config mode: "--config-benchmark [steps] [stack size]" compares the scene options against each other, starting from the given ones.
+    if (argc > 1 && std::strcmp(argv[1], "--config-benchmark") == 0)
+    {
+        unsigned int stepCount = getPositionalArgument(argc, argv, 2, 300u);
+        unsigned int stackSize = getPositionalArgument(argc, argv, 3, 20u);
 
-physx::PxRigidDynamic* createSphereProjectileFromCamera(Camera* camera);
-glm::mat4 getGlmTransformMatrixFromPhysX(physx::PxTransform t);
+        runSceneConfigBenchmark(stepCount, stackSize, workerCount, sceneConfig);
+        return EXIT_SUCCESS;
+    }
 
-int main()
-{
-    //init Nvidia PhysX API.
-    pFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, pAllocator, pError);
-    if (!pFoundation)
+    //Spawn mode: "--spawn-benchmark [bodies]" compares exclusive and shared shapes for identical boxes.
+    if (argc > 1 && std::strcmp(argv[1], "--spawn-benchmark") == 0)
     {
-        printf("ERROR: PhysX foundation failed.\n");
-        std::exit(EXIT_FAILURE);
+        unsigned int bodyCount = getPositionalArgument(argc, argv, 2, 100000u);
+
+        runSpawnBenchmark(bodyCount, workerCount);
+        return EXIT_SUCCESS;
     }
 
-    pPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *pFoundation, physx::PxTolerancesScale());
-    if (!pPhysics)
+    ThreadPool threadPool;
+    threadPool.initialise(workerCount, pinWorkers);
+    PoolCpuDispatcher dispatcher(threadPool);
+
+    //"--record path" logs the input of every frame, "--replay path" feeds a log back instead of live input.
+    //Both enable enhanced determinism, so a replay of the same scene reproduces the recorded session.
+    const char* recordPath = getOptionValue(argc, argv, "--record");
+    const char* replayPath = getOptionValue(argc, argv, "--replay");
+    InputReplay inputReplay;
+    if (replayPath && !inputReplay.open(replayPath))
+        std::exit(EXIT_FAILURE);
+
+    PhysicsWorld world;
+    world.setSceneConfig(sceneConfig);
+    world.initialise(&dispatcher, recordPath || replayPath);
+    if (physxProfilePath)
+        world.setPhysXProfiler(&physxProfiler);
+
+    //Scene load mode: "--load-benchmark [bodies]" times text parsing, binary loading and bulk insertion.
+    if (argc > 1 && std::strcmp(argv[1], "--load-benchmark") == 0)
     {
-        printf("ERROR: PhysX physics failed.\n");
+        unsigned int bodyCount = getPositionalArgument(argc, argv, 2, 100000u);
+
+        runSceneLoadBenchmark(world, bodyCount);
+        world.release();
+        return EXIT_SUCCESS;
+    }
+
+    //"--scene path" replaces the built in scene with a text or binary scene description.
+    const char* scenePath = getOptionValue(argc, argv, "--scene");
+    SceneDescription sceneDescription;
+    if (scenePath && !loadSceneDescription(scenePath, sceneDescription))
         std::exit(EXIT_FAILURE);
+
+    //Snapshot mode: "--save-snapshot path [steps]" settles the scene headless and writes a PhysX binary snapshot.
+    if (argc > 2 && std::strcmp(argv[1], "--save-snapshot") == 0)
+    {
+        unsigned int stepCount = getPositionalArgument(argc, argv, 3, 600u);
+
+        if (scenePath)
+            world.buildScene(sceneDescription);
+        else
+            world.createDefaultScene();
+        settleWorld(world, stepCount);
+
+        bool saved = world.saveSnapshot(argv[2]);
+        world.release();
+        return saved ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
-    //PhysX simulation time accumulator.
-    double pAccumulator = 0.0;
-    double pPhysicsStepSize = 1.0 / 60.0;
-
-    //Scene and scene descriptor.
-    physx::PxScene* pScene = nullptr;
-    
-    physx::PxSceneDesc pSceneDesc(pPhysics->getTolerancesScale());
-    pSceneDesc.gravity = physx::PxVec3(0.f, -9.8f, 0.f);
-    pSceneDesc.cpuDispatcher = physx::PxDefaultCpuDispatcherCreate(15);
-    pSceneDesc.filterShader = physx::PxDefaultSimulationFilterShader;
-    pSceneDesc.simulationEventCallback = &collisionCallback;
-    pSceneDesc.filterShader = customFilterShader;
-
-    pScene = pPhysics->createScene(pSceneDesc);
-
-    //Creating common material.
-    pMaterial = pPhysics->createMaterial(0.5f, 0.5f, 0.5f);
-
-    //Create rigid static actor. (Plane)
-    physx::PxTransform pPlaneRelativeTransform = physx::PxTransform(physx::PxVec3(0.f), physx::PxQuat(physx::PxHalfPi, physx::PxVec3(0.f, 0.f, 1.f)));
-    physx::PxTransform pPlaneGlobalTransform = physx::PxTransform(physx::PxVec3(0.f),physx::PxQuat(0.f,physx::PxVec3(0.f)));
-    physx::PxRigidStatic* pPlaneActor = pPhysics->createRigidStatic(pPlaneGlobalTransform);
-    physx::PxShape* pPlaneShape = physx::PxRigidActorExt::createExclusiveShape(*pPlaneActor, physx::PxPlaneGeometry(), *pMaterial);
-    pPlaneShape->setLocalPose(pPlaneRelativeTransform);
-    pScene->addActor(*pPlaneActor);
-
-    //Rigidbody dynamic container for tracking physics objects.
-    std::vector<physx::PxRigidDynamic*> rigidbodyDynamic;
-    //Projectile dynamic container for tracking camera projectiles.
-    std::vector < physx::PxRigidDynamic*> projectileDynamic;
-    //To obstruct creating vast numbers of projectiles we will use lock mechanism.
-    bool blockProjectileGeneration = false;
+    //"--snapshot path" restores a saved world instead of building one, settled bodies come up asleep.
+    const char* snapshotPath = getOptionValue(argc, argv, "--snapshot");
+    if (snapshotPath)
+    {
+        auto loadStart = std::chrono::high_resolution_clock::now();
+        if (!world.loadSnapshot(snapshotPath))
+            std::exit(EXIT_FAILURE);
+        double loadTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - loadStart).count();
+        printf("Snapshot loaded in %.1f ms, %zu dynamic bodies.\n", loadTime, world.getRigidbodyDynamic().size());
+    }
+    else if (scenePath)
+    {
+        world.buildScene(sceneDescription);
+    }
+
+    //Names the starting scene in input logs, replays of a different scene diverge immediately.
+    bool headless = argc > 1 && std::strcmp(argv[1], "--headless") == 0;
+    unsigned int stackSize = headless ? getPositionalArgument(argc, argv, 3, 5u) : 5u;
+    std::string sceneSource = snapshotPath ? std::string("snapshot ") + snapshotPath :
+        (scenePath ? std::string("scene ") + scenePath : "default " + std::to_string(stackSize));
+    if (replayPath && inputReplay.getSceneSource() != sceneSource)
+        printf("WARNING: Input log was recorded with \"%s\", replaying on \"%s\".\n", inputReplay.getSceneSource().c_str(), sceneSource.c_str());
+
+    if (!snapshotPath && !scenePath)
+        world.createDefaultScene(stackSize, stackSize);
 
-    //Create rigid dynamic actor. (Box)
-    unsigned int stackHeight = 5u, stackWidth = 5u;
-    for (size_t i = 0; i < stackHeight; i++)
+    //Headless mode: "--headless [steps] [stack size]" steps the world without creating a window or GL context.
+    //With "--replay" it runs the recorded frames back to back instead.
+    if (headless)
     {
-        for (size_t j = 0; j < stackWidth; j++)
+        unsigned int stepCount = getPositionalArgument(argc, argv, 2, 1000u);
+
+        if (replayPath)
+            runHeadlessReplay(world, inputReplay);
+        else
+            runHeadlessBenchmark(world, stepCount);
+        world.release();
+
+        if (physxProfilePath)
         {
-            physx::PxTransform pBoxTransform = physx::PxTransform(j * 2.f, i * 2.f + 5.f, 0.f);
-            physx::PxBoxGeometry PBoxGeometry(physx::PxVec3(1.f));
-            physx::PxRigidDynamic* pBoxActor = pPhysics->createRigidDynamic(pBoxTransform);
-            physx::PxShape* pBoxShape = physx::PxRigidActorExt::createExclusiveShape(*pBoxActor, PBoxGeometry, *pMaterial);
-            physx::PxRigidBodyExt::updateMassAndInertia(*pBoxActor, physx::PxReal(1.f));
-            rigidbodyDynamic.push_back(pBoxActor);
-            pScene->addActor(*pBoxActor);
+            physx::PxSetProfilerCallback(nullptr);
+            physxProfiler.writeHistograms(physxProfilePath, "headless, " + sceneSource, false);
         }
+        return EXIT_SUCCESS;
     }
 
-    //Create kinematic actor using sphere. (To simulate camera's effect on other dynamics)
-    physx::PxTransform pIntTransform = physx::PxTransform(physx::PxVec3(0.f));
-    physx::PxSphereGeometry pSphereGeometry(physx::PxReal(0.3f));
-    physx::PxRigidDynamic* pCameraActor = pPhysics->createRigidDynamic(pIntTransform);
-    physx::PxShape* pSphereShape = physx::PxRigidActorExt::createExclusiveShape(*pCameraActor, pSphereGeometry, *pMaterial);
-    pCameraActor->setRigidBodyFlag(physx::PxRigidBodyFlag::eKINEMATIC, true);
-    pScene->addActor(*pCameraActor);
+    //Query mode: "--query-benchmark [rays] [iterations]" casts a cone of rays at the unsimulated starting scene,
+    //batched on the thread pool and serially. The viewpoint faces the default stack.
+    if (argc > 1 && std::strcmp(argv[1], "--query-benchmark") == 0)
+    {
+        unsigned int rayCount = getPositionalArgument(argc, argv, 2, 10000u);
+        unsigned int iterationCount = getPositionalArgument(argc, argv, 3, 20u);
 
-    //Create a trigger shape using box.
-    pIntTransform = physx::PxTransform(physx::PxVec3(0.f,1.f,15.f));
-    physx::PxBoxGeometry pTriggerBoxGeometry(physx::PxVec3(5.f,1.f,5.f));
-    physx::PxRigidStatic* pTriggerActor = pPhysics->createRigidStatic(pIntTransform);
-    physx::PxShape* pTriggerBoxShape = physx::PxRigidActorExt::createExclusiveShape(*pTriggerActor, pTriggerBoxGeometry, *pMaterial);
+        runSceneQueryBenchmark(world.getScene(), threadPool, physx::PxVec3(5.f, 10.f, 30.f), physx::PxVec3(0.f, 0.f, -1.f), rayCount, iterationCount);
+        world.release();
+        return EXIT_SUCCESS;
+    }
 
-    pTriggerBoxShape->setFlag(physx::PxShapeFlag::eSIMULATION_SHAPE, false);
-    pTriggerBoxShape->setFlag(physx::PxShapeFlag::eTRIGGER_SHAPE, true);
+    physx::PxScene* pScene = world.getScene();
+    physx::PxRigidDynamic* pCameraActor = world.getCameraActor();
+    physx::PxRigidStatic* pTriggerActor = world.getTriggerActor();
+    std::vector<physx::PxRigidDynamic*>& rigidbodyDynamic = world.getRigidbodyDynamic();
 
-    pScene->addActor(*pTriggerActor);
+    //Fixed step scheduler, runs as many steps as accumulated frame time allows.
+    FixedStepScheduler scheduler;
+    //Kinematic camera actor target.
+    physx::PxTransform pInitTransform = physx::PxTransform(physx::PxVec3(0.f));
+    //To obstruct creating vast numbers of projectiles we will use lock mechanism.
+    bool blockProjectileGeneration = false;
+
+    InputRecorder inputRecorder;
+    if (recordPath && !inputRecorder.open(recordPath, sceneSource))
+        std::exit(EXIT_FAILURE);
+    uint64_t replayFrameIndex = 0u;
+    uint64_t replayStepIndex = 0u;
 
     const int screenWidth = 2560, screenHeight = 1440;
     const float near = 0.1f, far = 1000.f;
@@ -164,17 +285,77 @@ int main()
 
     glm::vec3 viewPos = glm::vec3(0.f);
 
-    Model sphere("resources/sphere.obj");
+    //Textures are decoded on the thread pool and uploaded a few per frame, placeholders are drawn until then.
+    AsyncTextureLoader textureLoader(threadPool);
+
+    //Model meshes share one vertex and index arena and their diffuse textures share one texture array,
+    //so a model of any mesh count is drawn with one multi draw indirect call.
+    const unsigned int modelAttributes = VERTEX_POSITION | VERTEX_NORMAL | VERTEX_TEXCOORDS;
+    GeometryArena geometryArena(modelAttributes);
+    TextureArray textureArray;
+    Model sphere("resources/sphere.obj", false, &textureLoader, modelAttributes, &geometryArena, &textureArray);
+
+    //Render side poses of dynamic bodies. Each actor's userData holds its render slot.
+    TransformCache transformCache;
+    for (physx::PxRigidDynamic* actor : rigidbodyDynamic)
+        transformCache.addBody(actor);
+
+    //Projectiles are pre-created once and recycled, firing does not allocate PhysX objects.
+    ProjectilePool projectilePool;
+    projectilePool.initialise(world);
+
+    //Bodies beyond pPhysicsDeleteThreshold, released once the running step is fetched.
+    std::vector<physx::PxRigidDynamic*> pendingRelease;
+
+    //Trigger and static boxes never move, their model matrices are built once. Scenes may have no trigger.
+    glm::mat4 triggerModel = pTriggerActor ? getStaticModelMatrix(pTriggerActor) : glm::mat4(1.f);
+    std::vector<glm::mat4> staticModels;
+    for (physx::PxRigidStatic* actor : world.getRigidbodyStatic())
+        staticModels.push_back(getStaticModelMatrix(actor));
+
+    //Persistent transforms of dynamic bodies, only awake and changed bodies are written each frame.
+    TransformBuffer cubeTransforms;
+    TransformBuffer sphereTransforms;
+    unsigned long long lastUploadedBytes = 0u;
+
+    //Only render slots whose cached world bounds touch the view frustum are drawn.
+    FrustumCuller frustumCuller;
+    std::vector<unsigned int> visibleBodies;
 
     Shader mShader("shader/main.vert","shader/main.frag");
     Shader gShader("shader/grid.vert", "shader/grid.frag");
 
-    unsigned int container = loadTextureFromFile("resources/container.jpg");
-    unsigned int red = loadTextureFromFile("resources/plastic.png");
-
-    //Always use texture unit 0.
+    unsigned int container = TextureCache::instance().acquire("resources/container.jpg", false, GL_CLAMP_TO_EDGE, &textureLoader);
+    unsigned int red = TextureCache::instance().acquire("resources/plastic.png", false, GL_CLAMP_TO_EDGE, &textureLoader);
+
+    //Uniform locations are resolved once, the render loop only uses these handles.
+    const int modelLocation = mShader.getUniformLocation("model");
+    const int isInstancedLocation = mShader.getUniformLocation("isInstanced");
+    const int isTextureArrayLocation = mShader.getUniformLocation("isTextureArray");
+    const int isWireframeLocation = mShader.getUniformLocation("isWireframe");
+    const int gridModelLocation = gShader.getUniformLocation("model");
+
+    //Triple buffered, persistently mapped memory for data rewritten every frame.
+    StreamBuffer streamBuffer;
+    double lastFenceWaitTime = 0.0;
+    CameraBuffer cameraBuffer;
+
+    //Per stage CPU and GPU timings. F1 prints min/avg/p99 per zone, F2 writes a Chrome trace of the recent frames.
+    //"--trace path" writes the trace and prints the report on exit.
+    FrameProfiler profiler;
+    const char* tracePath = getOptionValue(argc, argv, "--trace");
+    bool blockProfilerReport = false, blockProfilerTrace = false;
+
+    //Raycasts, sweeps and overlaps of a frame run as one batch on the thread pool once the frame's step is fetched.
+    //The camera's aim ray is answered in the same frame, after its step is fetched. F3 casts 10k rays in a cone from the camera.
+    SceneQueryService queryService(threadPool);
+    QueryHit aimHit = {};
+    bool runQueryBenchmark = false, blockQueryBenchmark = false;
+
+    //Always use texture unit 0, arena models read the texture array from its own unit.
     mShader.use();
     mShader.setInt("texture_diffuse0", 0);
+    mShader.setInt("textureArray", TextureArray::textureUnit);
     glActiveTexture(GL_TEXTURE0);
 
     while (!glfwWindowShouldClose(window))
@@ -184,191 +365,310 @@ int main()
         deltaTime = currentFrame - lastFrame;
         diffTime = currentTime - lastTime;
         lastFrame = currentFrame;
+        profiler.beginFrame();
 
         if (diffTime >= 1.0)
         {
             fpsToShow = counter;
             counter = 0;
             lastTime = currentTime;
-            glfwSetWindowTitle(window, std::to_string(fpsToShow).c_str());
+            unsigned long long uploadedBytes = cubeTransforms.getUploadedBytes() + sphereTransforms.getUploadedBytes();
+            std::string title = std::to_string(fpsToShow) + " FPS | visible bodies " +
+                std::to_string(frustumCuller.getVisibleCount()) + "/" + std::to_string(frustumCuller.getTotalCount()) +
+                " | transform upload " + std::to_string((uploadedBytes - lastUploadedBytes) / 1024u) + " KB/s" +
+                " | fence wait " + std::to_string((int)(streamBuffer.getTotalWaitTime() - lastFenceWaitTime)) + " ms/s" +
+                " | aim " + (aimHit.actor ? std::to_string((int)aimHit.distance) + " m" : std::string("-"));
+            lastUploadedBytes = uploadedBytes;
+            lastFenceWaitTime = streamBuffer.getTotalWaitTime();
+            glfwSetWindowTitle(window, title.c_str());
         }
 
+        profiler.beginZone("glfwPollEvents");
         glfwPollEvents();
+        profiler.endZone();
+        profiler.beginZone("texture uploads", true);
+        textureLoader.update();
+        textureArray.update(&textureLoader);
+        profiler.endZone();
         if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) && glfwGetKey(window, GLFW_KEY_X))
             glfwSetWindowShouldClose(window, true);
         if (glfwGetKey(window, GLFW_KEY_E))
             pPhysicsStart = true;
 
+        if (glfwGetKey(window, GLFW_KEY_F1) && !blockProfilerReport)
+            profiler.printReport();
+        blockProfilerReport = glfwGetKey(window, GLFW_KEY_F1);
+        if (glfwGetKey(window, GLFW_KEY_F2) && !blockProfilerTrace && profiler.writeChromeTrace("frame_trace.json"))
+            printf("Frame trace written to frame_trace.json\n");
+        blockProfilerTrace = glfwGetKey(window, GLFW_KEY_F2);
+        if (glfwGetKey(window, GLFW_KEY_F3) && !blockQueryBenchmark)
+            runQueryBenchmark = true;
+        blockQueryBenchmark = glfwGetKey(window, GLFW_KEY_F3);
+
+        bool fireProjectile = false;
         if (glfwGetKey(window,GLFW_KEY_SPACE) && !blockProjectileGeneration)
         {
             blockProjectileGeneration = true;
-
-            physx::PxRigidDynamic* projectileActor = createSphereProjectileFromCamera(&camera);
-            projectileDynamic.push_back(projectileActor);
-            pScene->addActor(*projectileActor);
-
+            fireProjectile = true;
         }
         else if (!glfwGetKey(window, GLFW_KEY_SPACE)) //If it is not pressed then 
         {
             blockProjectileGeneration = false;
         }
 
-        camera.update();
+        //A replay overrides camera, keys and step count with the recorded frame and ends with the log.
+        InputFrame inputFrame = {};
+        if (replayPath)
+        {
+            //The log is exhausted, the rest of this frame has no recorded input. Leaving the loop ends the run like closing the window.
+            if (replayFrameIndex == inputReplay.getFrameCount())
+                break;
+            inputFrame = inputReplay.getFrame(replayFrameIndex++);
+            camera.setCameraPosition(glm::vec3(inputFrame.position[0], inputFrame.position[1], inputFrame.position[2]));
+            camera.setCameraFront(glm::vec3(inputFrame.front[0], inputFrame.front[1], inputFrame.front[2]));
+            pPhysicsStart = (inputFrame.flags & INPUT_PHYSICS_STARTED) != 0u;
+            fireProjectile = (inputFrame.flags & INPUT_FIRE) != 0u;
+        }
+        else
+        {
+            profiler.beginZone("camera.update");
+            camera.update();
+            profiler.endZone();
+        }
         view = camera.getViewMatrix();
         viewPos = camera.getCameraPosition();
+        glm::vec3 viewFront = camera.getCameraFront();
+        queryService.addRaycast(physx::PxVec3(viewPos.x, viewPos.y, viewPos.z), physx::PxVec3(viewFront.x, viewFront.y, viewFront.z), far);
+
+        if (fireProjectile)
+            createSphereProjectileFromCamera(projectilePool, transformCache, viewPos, viewFront);
+
+        //In every frame it is essential to update kinematic dynamic actor which refers camera.
+        //Target is set before the step starts so it is applied by this frame's simulation.
+        pInitTransform.p = physx::PxVec3(viewPos.x, viewPos.y, viewPos.z);
+        pCameraActor->setKinematicTarget(pInitTransform);
 
         //Update Nvidia PhysX API.
         //CAUTION: PhysX is so sensitive to both very small, large and non constant time steps.
         //Updating simulation with deltatime may cause artifacts like jittering and undefined behavior.
-        if (pPhysicsStart)
+        unsigned int stepCount = 0u;
+        if (replayPath)
+        {
+            stepCount = (unsigned int)(inputFrame.stepIndex - replayStepIndex);
+            replayStepIndex = inputFrame.stepIndex;
+        }
+        else if (pPhysicsStart)
+        {
+            stepCount = scheduler.advance((double)deltaTime);
+        }
+        //Catch up steps only happen after a slow frame, they run synchronously.
+        profiler.beginZone("simulate");
+        for (unsigned int i = 1; i < stepCount; i++)
+        {
+            world.step();
+            //Read back only bodies that moved during this step.
+            transformCache.updateFromActiveActors(pScene);
+            transformCache.applySleepTransitions(world.getCollisionCallback());
+            drainContactEvents(world.getCollisionCallback());
+        }
+        //Last step runs on worker threads while this frame is rendered from the transform cache.
+        if (stepCount > 0)
+            world.beginStep();
+        profiler.endZone();
+        //Remaining accumulator time, bodies are drawn between their last two fetched poses.
+        //While a step is in flight the picture is one step behind the simulation.
+        const float alpha = replayPath ? inputFrame.alpha : (pPhysicsStart ? scheduler.getAlpha() : 1.f);
+
+        if (inputRecorder.isOpen())
         {
-            pAccumulator += (double)deltaTime;
-            if (pAccumulator >= pPhysicsStepSize)
-            {
-                pScene->simulate(pPhysicsStepSize);
-                pScene->fetchResults(true);
-
-                pAccumulator = 0.0;
-            }
+            InputFrame frame = { scheduler.getStepIndex(), (pPhysicsStart ? INPUT_PHYSICS_STARTED : 0u) | (fireProjectile ? INPUT_FIRE : 0u), alpha,
+                { viewPos.x, viewPos.y, viewPos.z }, { viewFront.x, viewFront.y, viewFront.z } };
+            inputRecorder.record(frame);
         }
 
+        //Per-frame GPU data is written into the next stream region, waiting here means the GPU is falling behind.
+        profiler.beginZone("stream fence wait");
+        streamBuffer.beginFrame();
+        profiler.endZone();
+
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         //Render dynamic rigidbody representation.
+        //View and projection are shared by every shader through the camera uniform buffer.
+        cameraBuffer.update(view, projection, streamBuffer);
+
         mShader.use();
-        mShader.setMat4("view", view);
-        mShader.setMat4("projection", projection);
         glBindTexture(GL_TEXTURE_2D, container);
 
-        //Query rigidbody world transform.
-        for (size_t i = 0; i < rigidbodyDynamic.size(); i++)
+        //Poses are read from the transform cache, which only changes for actors PhysX reported as active.
+        profiler.beginZone("cube loop");
+        collectDistantBodies(transformCache, viewPos, pendingRelease);
+
+        //Counters shown in the window title cover the last frame.
+        frustumCuller.setViewProjection(projection * view);
+        frustumCuller.resetCounters();
+
+        //Apply transformation to graphics. Bodies waiting for release stay valid until the step is fetched.
+        //Sleeping bodies keep their uploaded transform, awake ones are interpolated on the thread pool.
+        visibleBodies.clear();
+        frustumCuller.cull(transformCache.getCullBounds(BodyMesh::Cube), visibleBodies);
+        cubeTransforms.update(transformCache, BodyMesh::Cube, alpha, threadPool, streamBuffer);
+        cubeTransforms.setVisibleSlots(visibleBodies, streamBuffer);
+        profiler.endZone();
+
+        //Projectiles beyond pPhysicsDeleteThreshold are returned to the pool after the step is fetched.
+        profiler.beginZone("sphere loop");
+        visibleBodies.clear();
+        frustumCuller.cull(transformCache.getCullBounds(BodyMesh::Sphere), visibleBodies);
+        sphereTransforms.update(transformCache, BodyMesh::Sphere, alpha, threadPool, streamBuffer);
+        sphereTransforms.setVisibleSlots(visibleBodies, streamBuffer);
+        profiler.endZone();
+
+        //Every dynamic body of the same shape is drawn with one instanced draw call.
+        profiler.beginZone("instanced draw", true);
+        mShader.setBool(isInstancedLocation, true);
+        if (cubeTransforms.getVisibleCount() > 0)
         {
-            model = glm::mat4(1.f);
-
-            //Query rigidbody actor transform.
-            physx::PxTransform transform = rigidbodyDynamic.at(i)->getGlobalPose();
-            //Track object distance from view position in order to delete them if they exceed designated threshold.
-            glm::vec3 locationRelativeToViewPos(glm::vec3(transform.p.x, transform.p.y, transform.p.z) - viewPos);
-            if (glm::length(viewPos) > pPhysicsDeleteThreshold)
-            {
-                if (rigidbodyDynamic.at(i)->isReleasable())
-                {
-                    rigidbodyDynamic.at(i)->release();
-                    rigidbodyDynamic.erase(rigidbodyDynamic.begin() + i);
-                }
-            }
-
-            //Apply transformation to graphics.
-            model *= getGlmTransformMatrixFromPhysX(transform);
-
-            mShader.setMat4("model", model);
-            renderCube();
+            cubeTransforms.bind();
+            renderCubeInstanced(cubeTransforms.getVisibleCount());
         }
-
-        //Query projectile rigidbody world transform.
-        for (size_t i = 0; i < projectileDynamic.size(); i++)
+        if (sphereTransforms.getVisibleCount() > 0)
         {
-            model = glm::mat4(1.f);
-
-            //Query rigidbody actor transform.
-            physx::PxTransform transform = projectileDynamic.at(i)->getGlobalPose();
-            //Track object distance from view position in order to delete them if they exceed designated threshold.
-            glm::vec3 locationRelativeToViewPos(glm::vec3(transform.p.x, transform.p.y, transform.p.z) - viewPos);
-            if (glm::length(viewPos) > pPhysicsDeleteThreshold)
-            {
-                if (projectileDynamic.at(i)->isReleasable())
-                {
-                    projectileDynamic.at(i)->release();
-                    projectileDynamic.erase(projectileDynamic.begin() + i);
-                }
-            }
-
-            //Apply transformation to graphics.
-            model *= getGlmTransformMatrixFromPhysX(transform);
-
-            mShader.setMat4("model", model);
-            sphere.Draw(mShader);
+            sphereTransforms.bind();
+            mShader.setBool(isTextureArrayLocation, true);
+            sphere.DrawIndirect(sphereTransforms.getVisibleCount(), streamBuffer);
+            mShader.setBool(isTextureArrayLocation, false);
         }
+        mShader.setBool(isInstancedLocation, false);
+        profiler.endZone();
 
         //Render plane representation.
         model = glm::mat4(1.f);
         model = glm::scale(model, glm::vec3(1000.f, 0.f, 1000.f));
-        mShader.setMat4("model", model);
+        mShader.setMat4(modelLocation, model);
         glBindTexture(GL_TEXTURE_2D, red);
         renderCube();
 
-        //Render trigger representation. (in wireframe mode).
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        glDisable(GL_CULL_FACE);
-        mShader.setBool("isWireframe", true);
-
-        model = glm::mat4(1.f);
+        //Render static boxes of the scene.
+        glBindTexture(GL_TEXTURE_2D, container);
+        for (const glm::mat4& staticModel : staticModels)
         {
-            physx::PxTransform t = pTriggerActor->getGlobalPose();
-            model *= getGlmTransformMatrixFromPhysX(t);
-            model = glm::scale(model, glm::vec3(5.f, 1.f, 5.f));
+            mShader.setMat4(modelLocation, staticModel);
+            renderCube();
         }
-        mShader.setMat4("model", model);
-        glBindTexture(GL_TEXTURE_2D, container);
-        renderCube();
 
-        mShader.setBool("isWireframe", false);
-        glEnable(GL_CULL_FACE);
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        //Render trigger representation. (in wireframe mode).
+        if (pTriggerActor)
+        {
+            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+            glDisable(GL_CULL_FACE);
+            mShader.setBool(isWireframeLocation, true);
+
+            mShader.setMat4(modelLocation, triggerModel);
+            glBindTexture(GL_TEXTURE_2D, container);
+            renderCube();
+
+            mShader.setBool(isWireframeLocation, false);
+            glEnable(GL_CULL_FACE);
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        }
 
         //Render teleport destination box.
-        mShader.setBool("isWireframe", true);
+        mShader.setBool(isWireframeLocation, true);
 
         model = glm::mat4(1.f);
         model = glm::translate(model, glm::vec3(0.f, 15.f, 15.f));
-        mShader.setMat4("model", model);
+        mShader.setMat4(modelLocation, model);
         renderCube();
-        mShader.setBool("isWireframe", false);
-
-        //In every frame it is essential to update kinematic dynamic actor which refers camera.
-
-        pIntTransform.p = physx::PxVec3(viewPos.x, viewPos.y, viewPos.z);
-        pCameraActor->setKinematicTarget(pIntTransform);
+        mShader.setBool(isWireframeLocation, false);
 
+        profiler.beginZone("grid draw", true);
         gShader.use();
         model = glm::mat4(1.f);
-        gShader.setMat4("model", model);
-        gShader.setMat4("view", view);
-        gShader.setMat4("projection", projection);
+        gShader.setMat4(gridModelLocation, model);
         grid.draw(gShader);
+        profiler.endZone();
+        streamBuffer.endFrame();
 
         //------------------SWAP BUFFERS------------------
+        profiler.beginZone("glfwSwapBuffers");
         glfwSwapBuffers(window);
+        profiler.endZone();
         counter++;
+
+        //Collect the step started before rendering. Poll first, rendering usually hides the whole step.
+        profiler.beginZone("fetchResults");
+        if (world.isStepping())
+        {
+            if (!world.endStep(false))
+                world.endStep(true);
+            transformCache.updateFromActiveActors(pScene);
+            transformCache.applySleepTransitions(world.getCollisionCallback());
+            drainContactEvents(world.getCollisionCallback());
+        }
+        profiler.endZone();
+
+        //The scene is idle until the next frame's step, queries read it in parallel.
+        profiler.beginZone("scene queries");
+        queryService.execute(pScene);
+        aimHit = queryService.getRaycastCount() > 0u ? queryService.getRaycastHit(0u) : QueryHit();
+        profiler.endZone();
+        if (runQueryBenchmark)
+        {
+            runSceneQueryBenchmark(pScene, threadPool, physx::PxVec3(viewPos.x, viewPos.y, viewPos.z), physx::PxVec3(viewFront.x, viewFront.y, viewFront.z));
+            runQueryBenchmark = false;
+        }
+
+        projectilePool.cull(physx::PxVec3(viewPos.x, viewPos.y, viewPos.z), pPhysicsDeleteThreshold, transformCache);
+
+        for (physx::PxRigidDynamic* actor : pendingRelease)
+            transformCache.removeBody(actor);
+        world.releaseDynamics(pendingRelease);
+        pendingRelease.clear();
+        profiler.endFrame();
     }
 
-    //shutdown Nvidia PhysX API as reverse order of creation.
-    pScene->release();
-    pPhysics->release();
-    pFoundation->release();
+    if (tracePath)
+    {
+        profiler.printReport();
+        profiler.writeChromeTrace(tracePath);
+        printf("Stream buffer: %zu KB per frame, waited on %llu fences for %.3f ms, %llu overflowed allocations\n",
+            streamBuffer.getRegionSize() / 1024u, streamBuffer.getWaitCount(), streamBuffer.getTotalWaitTime(), streamBuffer.getOverflowCount());
+    }
+
+    //shutdown Nvidia PhysX API as reverse order of creation. Scene must be gone before its dispatcher's pool stops.
+    world.release();
+    threadPool.shutdown();
+
+    if (physxProfilePath)
+    {
+        physx::PxSetProfilerCallback(nullptr);
+        physxProfiler.writeHistograms(physxProfilePath, "windowed, " + sceneSource, false);
+    }
+
+    //Textures still referenced by models are deleted while the context is alive, later releases are ignored.
+    TextureCache::instance().releaseAll();
+    textureLoader.release();
+    profiler.release();
+    cubeTransforms.release();
+    sphereTransforms.release();
+    geometryArena.release();
+    textureArray.release();
+    streamBuffer.release();
 
     glfwDestroyWindow(window);
     glfwTerminate();
 }
 
-physx::PxRigidDynamic* createSphereProjectileFromCamera(Camera* camera)
+physx::PxRigidDynamic* createSphereProjectileFromCamera(ProjectilePool& pool, TransformCache& cache, glm::vec3 viewPos, glm::vec3 viewFront)
 {
     float distanceCoefficient = 10.f;
     float velocityCoefficient = 100.f;
 
-    glm::vec3 viewPos = camera->getCameraPosition();
-    glm::vec3 viewFront = camera->getCameraFront();
     glm::vec3 initPos = viewPos + distanceCoefficient * viewFront;
     physx::PxVec3 velocity = physx::PxVec3(viewFront.x,viewFront.y,viewFront.z) * velocityCoefficient;
 
-    physx::PxTransform t = physx::PxTransform(physx::PxVec3(initPos.x, initPos.y, initPos.z));
-    physx::PxSphereGeometry g = physx::PxSphereGeometry(1.f);
-    physx::PxRigidDynamic* actor = pPhysics->createRigidDynamic(t);
-    physx::PxRigidActorExt::createExclusiveShape(*actor, g, *pMaterial);
-    physx::PxRigidBodyExt::updateMassAndInertia(*actor, physx::PxReal(1.f));
-    actor->setLinearVelocity(velocity);
-
-    return actor;
+    return pool.spawn(physx::PxVec3(initPos.x, initPos.y, initPos.z), velocity, cache);
 }
 
 glm::mat4 getGlmTransformMatrixFromPhysX(physx::PxTransform t)
@@ -378,4 +678,207 @@ glm::mat4 getGlmTransformMatrixFromPhysX(physx::PxTransform t)
     glm::mat4 glmFormat = glm::make_mat4(fp16Format);
 
     return glmFormat;
-}
\ No newline at end of file
+}
+
+glm::mat4 getStaticModelMatrix(physx::PxRigidStatic* actor)
+{
+    //Cube mesh spans [-1, 1], scaling by the half extents of the first box shape matches the collider.
+    glm::mat4 model = getGlmTransformMatrixFromPhysX(actor->getGlobalPose());
+    physx::PxShape* shape = nullptr;
+    if (actor->getShapes(&shape, 1u) == 1u)
+    {
+        physx::PxGeometryHolder geometry(shape->getGeometry());
+        if (geometry.getType() == physx::PxGeometryType::eBOX)
+        {
+            const physx::PxVec3& halfExtents = geometry.box().halfExtents;
+            model = glm::scale(model, glm::vec3(halfExtents.x, halfExtents.y, halfExtents.z));
+        }
+    }
+
+    return model;
+}
+
+unsigned int drainContactEvents(CollisionCallback& callback)
+{
+    //Events are produced inside fetchResults, so draining after every fetch keeps the ring almost empty.
+    unsigned int contactCount = 0;
+    ContactEvent event;
+    while (callback.popEvent(event))
+    {
+        if (event.type == ContactEventType::Contact)
+            contactCount++;
+        else if (event.type == ContactEventType::TriggerEnter)
+            printf("Something entered trigger volume.\n");
+    }
+
+    return contactCount;
+}
+
+void settleWorld(PhysicsWorld& world, unsigned int maxStepCount)
+{
+    //Steps until every dynamic body sleeps, so a snapshot starts without warm up.
+    const std::vector<physx::PxRigidDynamic*>& bodies = world.getRigidbodyDynamic();
+    unsigned int stepCount = 0;
+    size_t awakeCount = bodies.size();
+    std::vector<SleepTransition> sleepTransitions;
+    while (stepCount < maxStepCount && awakeCount > 0u)
+    {
+        world.step();
+        drainContactEvents(world.getCollisionCallback());
+        //Nothing renders while settling.
+        world.getCollisionCallback().takeSleepTransitions(sleepTransitions);
+        stepCount++;
+
+        awakeCount = 0u;
+        for (physx::PxRigidDynamic* body : bodies)
+        {
+            if (!body->isSleeping())
+                awakeCount++;
+        }
+    }
+
+    printf("Settled for %u steps, %zu of %zu bodies still awake.\n", stepCount, awakeCount, bodies.size());
+}
+
+void collectDistantBodies(TransformCache& cache, glm::vec3 viewPos, std::vector<physx::PxRigidDynamic*>& pendingRelease)
+{
+    for (unsigned int i = cache.getBodyCount(BodyMesh::Cube); i-- > 0;)
+    {
+        const physx::PxTransform& transform = cache.getPose(BodyMesh::Cube, i);
+        //Track object distance from view position in order to delete them if they exceed designated threshold.
+        glm::vec3 locationRelativeToViewPos(glm::vec3(transform.p.x, transform.p.y, transform.p.z) - viewPos);
+        if (glm::length(locationRelativeToViewPos) > pPhysicsDeleteThreshold)
+        {
+            physx::PxRigidDynamic* actor = cache.getActor(BodyMesh::Cube, i);
+            //Actors cannot be released while a step is running, they are released after results are fetched.
+            if (actor->isReleasable())
+                pendingRelease.push_back(actor);
+        }
+    }
+}
+
+void runHeadlessReplay(PhysicsWorld& world, const InputReplay& replay)
+{
+    //Mirrors the physics side of the render loop call for call, rendering is skipped and steps run back to back.
+    physx::PxScene* pScene = world.getScene();
+    physx::PxRigidDynamic* pCameraActor = world.getCameraActor();
+
+    TransformCache transformCache;
+    for (physx::PxRigidDynamic* actor : world.getRigidbodyDynamic())
+        transformCache.addBody(actor);
+    ProjectilePool projectilePool;
+    projectilePool.initialise(world);
+    std::vector<physx::PxRigidDynamic*> pendingRelease;
+
+    uint64_t stepIndex = 0u;
+    auto replayStart = std::chrono::high_resolution_clock::now();
+    for (uint64_t frameIndex = 0; frameIndex < replay.getFrameCount(); frameIndex++)
+    {
+        const InputFrame& frame = replay.getFrame(frameIndex);
+        glm::vec3 viewPos(frame.position[0], frame.position[1], frame.position[2]);
+        glm::vec3 viewFront(frame.front[0], frame.front[1], frame.front[2]);
+
+        if (frame.flags & INPUT_FIRE)
+            createSphereProjectileFromCamera(projectilePool, transformCache, viewPos, viewFront);
+        pCameraActor->setKinematicTarget(physx::PxTransform(physx::PxVec3(viewPos.x, viewPos.y, viewPos.z)));
+
+        unsigned int stepCount = (unsigned int)(frame.stepIndex - stepIndex);
+        stepIndex = frame.stepIndex;
+        for (unsigned int i = 1; i < stepCount; i++)
+        {
+            world.step();
+            transformCache.updateFromActiveActors(pScene);
+            transformCache.applySleepTransitions(world.getCollisionCallback());
+            drainContactEvents(world.getCollisionCallback());
+        }
+        //The render loop checks distances while its last step is in flight.
+        collectDistantBodies(transformCache, viewPos, pendingRelease);
+        if (stepCount > 0)
+        {
+            world.step();
+            transformCache.updateFromActiveActors(pScene);
+            transformCache.applySleepTransitions(world.getCollisionCallback());
+            drainContactEvents(world.getCollisionCallback());
+        }
+
+        projectilePool.cull(physx::PxVec3(viewPos.x, viewPos.y, viewPos.z), pPhysicsDeleteThreshold, transformCache);
+        for (physx::PxRigidDynamic* actor : pendingRelease)
+            transformCache.removeBody(actor);
+        world.releaseDynamics(pendingRelease);
+        pendingRelease.clear();
+    }
+    double wallTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - replayStart).count();
+
+    //FNV-1a over final poses. Equal hashes across runs confirm the replay is deterministic.
+    unsigned long long stateHash = 14695981039346656037ull;
+    for (const std::vector<physx::PxRigidDynamic*>* list : { &world.getRigidbodyDynamic(), &world.getProjectileDynamic() })
+    {
+        for (physx::PxRigidDynamic* actor : *list)
+        {
+            physx::PxTransform pose = actor->getGlobalPose();
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&pose);
+            for (size_t i = 0; i < sizeof(pose); i++)
+                stateHash = (stateHash ^ bytes[i]) * 1099511628211ull;
+        }
+    }
+
+    printf("Headless replay: %llu frames, %llu steps\n", (unsigned long long)replay.getFrameCount(), (unsigned long long)stepIndex);
+    printf("  wall time     : %.3f s\n", wallTime);
+    printf("  steps/sec     : %.1f\n", wallTime > 0.0 ? stepIndex / wallTime : 0.0);
+    printf("  state hash    : %016llx\n", stateHash);
+}
+
+bool hasOption(int argc, char** argv, const char* name)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], name) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+const char* getOptionValue(int argc, char** argv, const char* name)
+{
+    //Returns the argument after "name". Null when the option or its value is missing.
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], name) == 0)
+            return argv[i + 1];
+    }
+
+    return nullptr;
+}
+
+unsigned int getPositionalArgument(int argc, char** argv, int index, unsigned int defaultValue)
+{
+    //Options like "--workers" may follow the positional arguments.
+    if (index >= argc || argv[index][0] == '-')
+        return defaultValue;
+
+    return (unsigned int)std::strtoul(argv[index], nullptr, 10);
+}
+
+bool getSceneConfig(int argc, char** argv, SceneConfig& config)
+{
+    const char* broadPhase = getOptionValue(argc, argv, "--broadphase");
+    if (broadPhase && !parseBroadPhaseType(broadPhase, config.broadPhase))
+        return false;
+    const char* solver = getOptionValue(argc, argv, "--solver");
+    if (solver && !parseSolverType(solver, config.solver))
+        return false;
+    const char* friction = getOptionValue(argc, argv, "--friction");
+    if (friction && !parseFrictionType(friction, config.friction))
+        return false;
+
+    if (hasOption(argc, argv, "--pcm"))
+        config.pcm = true;
+    if (hasOption(argc, argv, "--no-pcm"))
+        config.pcm = false;
+    if (hasOption(argc, argv, "--stabilization"))
+        config.stabilization = true;
+    if (hasOption(argc, argv, "--ccd"))
+        config.ccd = true;
+    return true;
+}
@@ -0,0 +1,131 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() :
+	mappedData(nullptr),
+	mappedSize(0u),
+	writable(false),
+#ifdef _WIN32
+	fileHandle(nullptr),
+	mappingHandle(nullptr)
+#else
+	fileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const std::string& path, bool copyOnWrite)
+{
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	mappingHandle = CreateFileMappingA(file, nullptr, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle)
+	{
+		close();
+		return false;
+	}
+
+	mappedData = static_cast<unsigned char*>(MapViewOfFile(mappingHandle, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+	if (!mappedData)
+	{
+		close();
+		return false;
+	}
+	mappedSize = (size_t)fileSize.QuadPart;
+#else
+	fileDescriptor = ::open(path.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+		return false;
+
+	struct stat fileStatus;
+	if (fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+	{
+		close();
+		return false;
+	}
+
+	void* address = mmap(nullptr, (size_t)fileStatus.st_size, copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (address == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+	mappedData = static_cast<unsigned char*>(address);
+	mappedSize = (size_t)fileStatus.st_size;
+#endif
+
+	writable = copyOnWrite;
+	return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (mappedData)
+		UnmapViewOfFile(mappedData);
+	if (mappingHandle)
+		CloseHandle(mappingHandle);
+	if (fileHandle)
+		CloseHandle(fileHandle);
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+#else
+	if (mappedData)
+		munmap(mappedData, mappedSize);
+	if (fileDescriptor >= 0)
+		::close(fileDescriptor);
+	fileDescriptor = -1;
+#endif
+
+	mappedData = nullptr;
+	mappedSize = 0u;
+	writable = false;
+}
+
+const unsigned char* MappedFile::data() const
+{
+	return mappedData;
+}
+
+unsigned char* MappedFile::mutableData()
+{
+	return writable ? mappedData : nullptr;
+}
+
+size_t MappedFile::size() const
+{
+	return mappedSize;
+}
+
+bool MappedFile::isOpen() const
+{
+	return mappedData != nullptr;
+}
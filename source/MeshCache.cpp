@@ -0,0 +1,258 @@
+#include "MeshCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+//File layout, every block starts at an 8 byte boundary:
+//  MeshCacheHeader, source path
+//  per mesh: MeshCacheRecord, per texture (uint32 type length, uint32 path length, type, path), vertices, indices
+struct MeshCacheHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t importFlags;
+	uint32_t vertexStride;
+	int64_t sourceWriteTime;
+	uint64_t sourceSize;
+	uint32_t sourcePathLength;
+	uint32_t meshCount;
+};
+
+struct MeshCacheRecord
+{
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t textureCount;
+	uint32_t attributes;
+};
+
+static const char meshCacheMagic[4] = { 'P', 'X', 'M', 'C' };
+
+static size_t alignTo8(size_t value)
+{
+	return (value + 7u) & ~size_t(7u);
+}
+
+//Fills source identity fields of the header. Returns false when the source cannot be inspected.
+static bool describeSource(const std::string& sourcePath, std::string& key, int64_t& writeTime, uint64_t& size)
+{
+	std::error_code error;
+	std::filesystem::path path(sourcePath);
+	auto time = std::filesystem::last_write_time(path, error);
+	if (error)
+		return false;
+	size = (uint64_t)std::filesystem::file_size(path, error);
+	if (error)
+		return false;
+
+	writeTime = (int64_t)time.time_since_epoch().count();
+	key = std::filesystem::absolute(path, error).generic_string();
+	return !error;
+}
+
+//Bounds checked cursor over mapped bytes.
+class CacheCursor
+{
+public:
+	CacheCursor(const unsigned char* data, size_t size) : begin(data), end(data + size), current(data) {}
+
+	const unsigned char* take(size_t byteCount)
+	{
+		if ((size_t)(end - current) < byteCount)
+			return nullptr;
+		const unsigned char* result = current;
+		current += byteCount;
+		return result;
+	}
+
+	bool skipPadding()
+	{
+		size_t offset = (size_t)(current - begin);
+		return take(alignTo8(offset) - offset) != nullptr;
+	}
+
+private:
+	const unsigned char* begin;
+	const unsigned char* end;
+	const unsigned char* current;
+};
+
+bool MeshCacheReader::open(const std::string& sourcePath, unsigned int importFlags)
+{
+	close();
+
+	std::string key;
+	int64_t writeTime;
+	uint64_t sourceSize;
+	if (!describeSource(sourcePath, key, writeTime, sourceSize))
+		return false;
+
+	if (!file.open(getMeshCachePath(sourcePath)))
+		return false;
+
+	CacheCursor cursor(file.data(), file.size());
+	const MeshCacheHeader* header = reinterpret_cast<const MeshCacheHeader*>(cursor.take(sizeof(MeshCacheHeader)));
+	if (!header || std::memcmp(header->magic, meshCacheMagic, sizeof(meshCacheMagic)) != 0 ||
+		header->version != pMeshCacheVersion || header->vertexStride != sizeof(Vertex) || header->importFlags != importFlags ||
+		header->sourceWriteTime != writeTime || header->sourceSize != sourceSize || header->sourcePathLength != key.size())
+	{
+		close();
+		return false;
+	}
+
+	const char* storedKey = reinterpret_cast<const char*>(cursor.take(header->sourcePathLength));
+	if (!storedKey || std::memcmp(storedKey, key.data(), key.size()) != 0 || !cursor.skipPadding())
+	{
+		close();
+		return false;
+	}
+
+	meshes.reserve(header->meshCount);
+	for (uint32_t i = 0; i < header->meshCount; i++)
+	{
+		const MeshCacheRecord* record = reinterpret_cast<const MeshCacheRecord*>(cursor.take(sizeof(MeshCacheRecord)));
+		if (!record)
+		{
+			close();
+			return false;
+		}
+
+		CachedMesh mesh;
+		mesh.attributes = record->attributes;
+		for (uint32_t j = 0; j < record->textureCount; j++)
+		{
+			const uint32_t* lengths = reinterpret_cast<const uint32_t*>(cursor.take(2u * sizeof(uint32_t)));
+			const char* type = lengths ? reinterpret_cast<const char*>(cursor.take(lengths[0])) : nullptr;
+			const char* path = type ? reinterpret_cast<const char*>(cursor.take(lengths[1])) : nullptr;
+			if (!path || !cursor.skipPadding())
+			{
+				close();
+				return false;
+			}
+
+			Texture texture;
+			texture.id = 0u;
+			texture.type.assign(type, lengths[0]);
+			texture.path.assign(path, lengths[1]);
+			mesh.textures.push_back(texture);
+		}
+
+		mesh.vertexCount = record->vertexCount;
+		mesh.vertices = reinterpret_cast<const Vertex*>(cursor.take((size_t)record->vertexCount * sizeof(Vertex)));
+		if (!mesh.vertices || !cursor.skipPadding())
+		{
+			close();
+			return false;
+		}
+
+		mesh.indexCount = record->indexCount;
+		mesh.indices = reinterpret_cast<const unsigned int*>(cursor.take((size_t)record->indexCount * sizeof(unsigned int)));
+		if (!mesh.indices || !cursor.skipPadding())
+		{
+			close();
+			return false;
+		}
+
+		meshes.push_back(std::move(mesh));
+	}
+
+	return true;
+}
+
+void MeshCacheReader::close()
+{
+	meshes.clear();
+	file.close();
+}
+
+const std::vector<CachedMesh>& MeshCacheReader::getMeshes() const
+{
+	return meshes;
+}
+
+std::string getMeshCachePath(const std::string& sourcePath)
+{
+	return sourcePath + ".meshcache";
+}
+
+//Appends bytes and pads the stream to the next 8 byte boundary.
+static void writeAligned(std::ofstream& stream, const void* data, size_t byteCount)
+{
+	static const char padding[8] = {};
+	if (byteCount > 0u)
+		stream.write(static_cast<const char*>(data), (std::streamsize)byteCount);
+
+	size_t offset = (size_t)stream.tellp();
+	stream.write(padding, (std::streamsize)(alignTo8(offset) - offset));
+}
+
+bool writeMeshCache(const std::string& sourcePath, unsigned int importFlags, const std::vector<Mesh>& meshes, const std::vector<unsigned int>& assetAttributes)
+{
+	MeshCacheHeader header = {};
+	std::string key;
+	if (!describeSource(sourcePath, key, header.sourceWriteTime, header.sourceSize))
+		return false;
+
+	std::memcpy(header.magic, meshCacheMagic, sizeof(meshCacheMagic));
+	header.version = pMeshCacheVersion;
+	header.importFlags = importFlags;
+	header.vertexStride = sizeof(Vertex);
+	header.sourcePathLength = (uint32_t)key.size();
+	header.meshCount = (uint32_t)meshes.size();
+
+	//Written to a temporary file first so a crash never leaves a truncated cache behind.
+	std::string cachePath = getMeshCachePath(sourcePath);
+	std::string temporaryPath = cachePath + ".tmp";
+	{
+		std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!stream)
+		{
+			printf("WARNING: Mesh cache could not be written to %s.\n", temporaryPath.c_str());
+			return false;
+		}
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		writeAligned(stream, key.data(), key.size());
+
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			const Mesh& mesh = meshes[i];
+			MeshCacheRecord record = {};
+			record.attributes = i < assetAttributes.size() ? assetAttributes[i] : (uint32_t)VERTEX_ALL;
+			record.vertexCount = (uint32_t)mesh.vertices.size();
+			record.indexCount = (uint32_t)mesh.indices.size();
+			record.textureCount = (uint32_t)mesh.textures.size();
+			stream.write(reinterpret_cast<const char*>(&record), sizeof(record));
+
+			for (const Texture& texture : mesh.textures)
+			{
+				uint32_t lengths[2] = { (uint32_t)texture.type.size(), (uint32_t)texture.path.size() };
+				stream.write(reinterpret_cast<const char*>(lengths), sizeof(lengths));
+				stream.write(texture.type.data(), (std::streamsize)texture.type.size());
+				writeAligned(stream, texture.path.data(), texture.path.size());
+			}
+
+			writeAligned(stream, mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+			writeAligned(stream, mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+		}
+
+		if (!stream)
+		{
+			printf("WARNING: Mesh cache could not be written to %s.\n", temporaryPath.c_str());
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, cachePath, error);
+	if (error)
+	{
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+
+	return true;
+}
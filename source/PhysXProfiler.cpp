@@ -0,0 +1,205 @@
+#include "PhysXProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+//Buckets are powers of two in microseconds, bucket i holds values below 2^i us.
+static constexpr unsigned int histogramBucketCount = 24u;
+
+static std::atomic<unsigned long long> nextProfilerId(1u);
+
+//Buffer of the calling thread for the profiler with "threadProfilerId". Ids are never reused,
+//so a profiler created at the address of a destroyed one does not pick up stale buffers.
+static thread_local unsigned long long threadProfilerId = 0u;
+static thread_local void* threadBuffer = nullptr;
+
+static uint64_t readClock()
+{
+	return (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+static float percentile(std::vector<float> samples, double p)
+{
+	if (samples.empty())
+		return 0.f;
+
+	std::sort(samples.begin(), samples.end());
+	return samples[std::min((size_t)(p * (samples.size() - 1) + 0.5), samples.size() - 1)];
+}
+
+PhysXProfiler::ThreadBuffer::ThreadBuffer(size_t capacity) :
+	events(capacity),
+	droppedCount(0u)
+{
+}
+
+PhysXProfiler::PhysXProfiler(size_t eventsPerThread) :
+	id(nextProfilerId.fetch_add(1u)),
+	capacity(eventsPerThread),
+	ticksToMicroseconds(1000000.0 * std::chrono::high_resolution_clock::period::num / std::chrono::high_resolution_clock::period::den),
+	stepCount(0u),
+	droppedEventCount(0u)
+{
+}
+
+void* PhysXProfiler::zoneStart(const char*, bool, uint64_t)
+{
+	//Start time travels through PhysX as profilerData, so detached zones ending on another thread still work.
+	return reinterpret_cast<void*>((uintptr_t)readClock());
+}
+
+void PhysXProfiler::zoneEnd(void* profilerData, const char* eventName, bool, uint64_t)
+{
+	uint64_t end = readClock();
+	ThreadBuffer* buffer = getThreadBuffer();
+	if (!buffer->events.push({ eventName, (uint64_t)reinterpret_cast<uintptr_t>(profilerData), end }))
+		buffer->droppedCount.fetch_add(1u, std::memory_order_relaxed);
+}
+
+void PhysXProfiler::endStep()
+{
+	struct StepZone
+	{
+		uint64_t total;
+		uint64_t firstStart;
+		uint64_t lastEnd;
+		unsigned int calls;
+	};
+	std::unordered_map<const char*, StepZone> step;
+
+	{
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		for (const std::unique_ptr<ThreadBuffer>& buffer : buffers)
+		{
+			ZoneEvent event;
+			while (buffer->events.pop(event))
+			{
+				auto inserted = step.emplace(event.name, StepZone{ 0u, event.start, event.end, 0u });
+				StepZone& zone = inserted.first->second;
+				zone.total += event.end - event.start;
+				zone.firstStart = std::min(zone.firstStart, event.start);
+				zone.lastEnd = std::max(zone.lastEnd, event.end);
+				zone.calls++;
+			}
+			droppedEventCount += buffer->droppedCount.exchange(0u, std::memory_order_relaxed);
+		}
+	}
+
+	for (const auto& entry : step)
+	{
+		ZoneHistory& history = zones[entry.first];
+		history.totals.push_back((float)(entry.second.total * ticksToMicroseconds));
+		history.spans.push_back((float)((entry.second.lastEnd - entry.second.firstStart) * ticksToMicroseconds));
+		history.callCount += entry.second.calls;
+	}
+	stepCount++;
+}
+
+void PhysXProfiler::reset()
+{
+	//Events of the interrupted step are discarded with the history.
+	{
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		for (const std::unique_ptr<ThreadBuffer>& buffer : buffers)
+		{
+			ZoneEvent event;
+			while (buffer->events.pop(event))
+			{
+			}
+			buffer->droppedCount.store(0u, std::memory_order_relaxed);
+		}
+	}
+
+	zones.clear();
+	stepCount = 0u;
+	droppedEventCount = 0u;
+}
+
+bool PhysXProfiler::writeHistograms(const std::string& path, const std::string& label, bool append) const
+{
+	FILE* file = std::fopen(path.c_str(), append ? "a" : "w");
+	if (!file)
+	{
+		printf("ERROR: PhysX profile could not be written: %s\n", path.c_str());
+		return false;
+	}
+
+	//Most expensive zones first.
+	std::vector<std::pair<const char*, const ZoneHistory*>> sorted;
+	for (const auto& entry : zones)
+		sorted.push_back({ entry.first, &entry.second });
+	auto average = [this](const ZoneHistory& history)
+	{
+		double sum = 0.0;
+		for (float total : history.totals)
+			sum += total;
+		return stepCount > 0u ? sum / stepCount : 0.0;
+	};
+	std::sort(sorted.begin(), sorted.end(), [&](const auto& a, const auto& b) { return average(*a.second) > average(*b.second); });
+
+	std::fprintf(file, "# %s: %llu steps, %zu threads, %llu dropped events\n", label.c_str(), stepCount, buffers.size(), droppedEventCount);
+	std::fprintf(file, "%-40s %10s %10s %10s %10s %10s %8s  histogram of us per step (upper bound:steps)\n",
+		"zone", "calls/step", "avg us", "p50 us", "p99 us", "max us", "threads");
+
+	for (const auto& entry : sorted)
+	{
+		const ZoneHistory& history = *entry.second;
+
+		//Average concurrency, total busy time over wall time the zone was open. Near one means the stage is serial.
+		double totalSum = 0.0, spanSum = 0.0;
+		for (size_t i = 0; i < history.totals.size(); i++)
+		{
+			totalSum += history.totals[i];
+			spanSum += history.spans[i];
+		}
+
+		std::fprintf(file, "%-40s %10.1f %10.1f %10.1f %10.1f %10.1f %8.2f ", entry.first,
+			stepCount > 0u ? (double)history.callCount / stepCount : 0.0, average(history),
+			percentile(history.totals, 0.5), percentile(history.totals, 0.99),
+			history.totals.empty() ? 0.f : *std::max_element(history.totals.begin(), history.totals.end()),
+			spanSum > 0.0 ? totalSum / spanSum : 0.0);
+
+		unsigned long long buckets[histogramBucketCount] = {};
+		for (float total : history.totals)
+		{
+			unsigned int bucket = total < 1.f ? 0u : (unsigned int)std::log2(total) + 1u;
+			buckets[std::min(bucket, histogramBucketCount - 1u)]++;
+		}
+		for (unsigned int i = 0; i < histogramBucketCount; i++)
+		{
+			if (buckets[i] > 0u)
+				std::fprintf(file, " %llu:%llu", 1ull << i, buckets[i]);
+		}
+		std::fprintf(file, "\n");
+	}
+	std::fprintf(file, "\n");
+
+	bool written = std::ferror(file) == 0;
+	std::fclose(file);
+	return written;
+}
+
+unsigned long long PhysXProfiler::getStepCount() const
+{
+	return stepCount;
+}
+
+unsigned long long PhysXProfiler::getDroppedEventCount() const
+{
+	return droppedEventCount;
+}
+
+PhysXProfiler::ThreadBuffer* PhysXProfiler::getThreadBuffer()
+{
+	if (threadProfilerId == id)
+		return static_cast<ThreadBuffer*>(threadBuffer);
+
+	//First zone of this thread. Buffers of exited threads stay registered until the profiler is destroyed.
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	buffers.push_back(std::make_unique<ThreadBuffer>(capacity));
+	threadProfilerId = id;
+	threadBuffer = buffers.back().get();
+	return buffers.back().get();
+}
@@ -0,0 +1,711 @@
+#include "PhysicsWorld.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_set>
+
+#include "FilterShader.h"
+
+//Snapshot object ids are (role << 32) | index, zero stays PX_SERIAL_OBJECT_ID_INVALID.
+enum class SnapshotRole : physx::PxU64
+{
+	Camera = 1u,
+	Trigger = 2u,
+	Dynamic = 3u,
+	Static = 4u,
+	Other = 5u
+};
+
+static physx::PxSerialObjectId makeSnapshotId(SnapshotRole role, size_t index)
+{
+	return ((physx::PxU64)role << 32) | (physx::PxU64)index;
+}
+
+static void setSceneFlag(physx::PxSceneFlags& flags, physx::PxSceneFlag::Enum flag, bool enabled)
+{
+	if (enabled)
+		flags.raise(flag);
+	else
+		flags.clear(flag);
+}
+
+PhysicsWorld::PhysicsWorld() :
+	pFoundation(nullptr),
+	pPhysics(nullptr),
+	pDispatcher(nullptr),
+	pScene(nullptr),
+	pMaterial(nullptr),
+	pSerializationRegistry(nullptr),
+	pCameraActor(nullptr),
+	pTriggerActor(nullptr),
+	physxProfiler(nullptr),
+	shareShapes(true),
+	integrateMass(false),
+	stepping(false)
+{
+}
+
+PhysicsWorld::~PhysicsWorld()
+{
+	release();
+}
+
+void PhysicsWorld::initialise(physx::PxU32 workerCount, bool enhancedDeterminism)
+{
+	createWorld(nullptr, workerCount, enhancedDeterminism);
+}
+
+void PhysicsWorld::initialise(physx::PxCpuDispatcher* dispatcher, bool enhancedDeterminism)
+{
+	createWorld(dispatcher, 0u, enhancedDeterminism);
+}
+
+void PhysicsWorld::createWorld(physx::PxCpuDispatcher* dispatcher, physx::PxU32 workerCount, bool enhancedDeterminism)
+{
+	//init Nvidia PhysX API.
+	pFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, pAllocator, pError);
+	if (!pFoundation)
+	{
+		printf("ERROR: PhysX foundation failed.\n");
+		std::exit(EXIT_FAILURE);
+	}
+
+	pPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *pFoundation, physx::PxTolerancesScale());
+	if (!pPhysics)
+	{
+		printf("ERROR: PhysX physics failed.\n");
+		std::exit(EXIT_FAILURE);
+	}
+
+	shapeRegistry.initialise(pPhysics);
+
+	//Default dispatcher allocates through the foundation, so it is created after it.
+	if (!dispatcher)
+	{
+		pDispatcher = physx::PxDefaultCpuDispatcherCreate(workerCount);
+		dispatcher = pDispatcher;
+	}
+
+	//Scene and scene descriptor.
+	physx::PxSceneDesc pSceneDesc(pPhysics->getTolerancesScale());
+	pSceneDesc.gravity = physx::PxVec3(0.f, -9.8f, 0.f);
+	pSceneDesc.cpuDispatcher = dispatcher;
+	pSceneDesc.simulationEventCallback = &collisionCallback;
+	pSceneDesc.filterShader = customFilterShader;
+	//Active actors let the renderer read back only bodies that moved during the last step.
+	pSceneDesc.flags |= physx::PxSceneFlag::eENABLE_ACTIVE_ACTORS;
+	pSceneDesc.flags |= physx::PxSceneFlag::eEXCLUDE_KINEMATICS_FROM_ACTIVE_ACTORS;
+	//Results no longer depend on actor insertion order or on which pairs other bodies happen to touch.
+	if (enhancedDeterminism)
+		pSceneDesc.flags |= physx::PxSceneFlag::eENABLE_ENHANCED_DETERMINISM;
+
+	pSceneDesc.broadPhaseType = sceneConfig.broadPhase;
+	pSceneDesc.solverType = sceneConfig.solver;
+	pSceneDesc.frictionType = sceneConfig.friction;
+	setSceneFlag(pSceneDesc.flags, physx::PxSceneFlag::eENABLE_PCM, sceneConfig.pcm);
+	setSceneFlag(pSceneDesc.flags, physx::PxSceneFlag::eENABLE_STABILIZATION, sceneConfig.stabilization);
+	setSceneFlag(pSceneDesc.flags, physx::PxSceneFlag::eENABLE_CCD, sceneConfig.ccd);
+
+	pScene = pPhysics->createScene(pSceneDesc);
+	if (!pScene)
+	{
+		printf("ERROR: PhysX scene failed.\n");
+		std::exit(EXIT_FAILURE);
+	}
+
+	//Creating common material.
+	pMaterial = pPhysics->createMaterial(0.5f, 0.5f, 0.5f);
+}
+
+void PhysicsWorld::createDefaultScene(unsigned int stackHeight, unsigned int stackWidth)
+{
+	SceneDescription description;
+
+	SceneElement plane = {};
+	plane.type = SceneElementType::Plane;
+	description.elements.push_back(plane);
+
+	SceneElement stack = {};
+	stack.type = SceneElementType::Stack;
+	stack.counts[0] = stackWidth;
+	stack.counts[1] = stackHeight;
+	stack.position[1] = 5.f;
+	stack.size[0] = stack.size[1] = stack.size[2] = 1.f;
+	stack.density = 1.f;
+	description.elements.push_back(stack);
+
+	SceneElement trigger = {};
+	trigger.type = SceneElementType::Trigger;
+	trigger.position[1] = 1.f;
+	trigger.position[2] = 15.f;
+	trigger.size[0] = 5.f;
+	trigger.size[1] = 1.f;
+	trigger.size[2] = 5.f;
+	description.elements.push_back(trigger);
+
+	buildScene(description);
+}
+
+void PhysicsWorld::buildScene(const SceneDescription& description)
+{
+	std::vector<physx::PxMaterial*> materials;
+	materials.reserve(description.materials.size());
+	for (const SceneMaterial& material : description.materials)
+		materials.push_back(pPhysics->createMaterial(material.staticFriction, material.dynamicFriction, material.restitution));
+
+	std::vector<physx::PxActor*> actors;
+	actors.reserve(description.getActorCount());
+	rigidbodyDynamic.reserve(rigidbodyDynamic.size() + description.getActorCount());
+
+	//updateMassAndInertia() integrates over the shapes, closed forms are much cheaper for large scenes.
+	//Shared shapes carry their mass properties, identical bodies then cost one shape in total.
+	auto addBox = [&](const physx::PxVec3& position, const physx::PxVec3& halfExtents, float density, physx::PxMaterial& material)
+	{
+		physx::PxRigidDynamic* actor = pPhysics->createRigidDynamic(physx::PxTransform(position));
+		const SharedShape* shared = shareShapes ? shapeRegistry.acquire(physx::PxBoxGeometry(halfExtents), material) : nullptr;
+		if (shared)
+		{
+			ShapeRegistry::attach(*actor, *shared, density);
+		}
+		else
+		{
+			physx::PxRigidActorExt::createExclusiveShape(*actor, physx::PxBoxGeometry(halfExtents), material);
+			if (integrateMass)
+			{
+				physx::PxRigidBodyExt::updateMassAndInertia(*actor, density);
+			}
+			else
+			{
+				float mass = density * 8.f * halfExtents.x * halfExtents.y * halfExtents.z;
+				physx::PxVec3 squared = halfExtents.multiply(halfExtents);
+				actor->setMass(mass);
+				actor->setMassSpaceInertiaTensor(physx::PxVec3(squared.y + squared.z, squared.x + squared.z, squared.x + squared.y) * (mass / 3.f));
+			}
+		}
+		//Sleep and wake notifications drive which render transforms are rewritten.
+		actor->setActorFlag(physx::PxActorFlag::eSEND_SLEEP_NOTIFIES, true);
+		rigidbodyDynamic.push_back(actor);
+		actors.push_back(actor);
+	};
+
+	float cameraRadius = 0.3f;
+	for (const SceneElement& element : description.elements)
+	{
+		physx::PxMaterial& material = *materials[element.material];
+		physx::PxVec3 position(element.position[0], element.position[1], element.position[2]);
+		physx::PxVec3 size(element.size[0], element.size[1], element.size[2]);
+
+		switch (element.type)
+		{
+		case SceneElementType::Plane:
+		{
+			//Plane geometry faces +x, rotate it to face +y.
+			physx::PxRigidStatic* actor = pPhysics->createRigidStatic(physx::PxTransform(physx::PxIdentity));
+			physx::PxShape* shape = physx::PxRigidActorExt::createExclusiveShape(*actor, physx::PxPlaneGeometry(), material);
+			shape->setLocalPose(physx::PxTransform(physx::PxVec3(0.f), physx::PxQuat(physx::PxHalfPi, physx::PxVec3(0.f, 0.f, 1.f))));
+			actors.push_back(actor);
+			break;
+		}
+		case SceneElementType::Box:
+			addBox(position, size, element.density, material);
+			break;
+		case SceneElementType::Sphere:
+		{
+			physx::PxRigidDynamic* actor = pPhysics->createRigidDynamic(physx::PxTransform(position));
+			const SharedShape* shared = shareShapes ? shapeRegistry.acquire(physx::PxSphereGeometry(size.x), material) : nullptr;
+			if (shared)
+			{
+				ShapeRegistry::attach(*actor, *shared, element.density);
+			}
+			else
+			{
+				physx::PxRigidActorExt::createExclusiveShape(*actor, physx::PxSphereGeometry(size.x), material);
+				if (integrateMass)
+				{
+					physx::PxRigidBodyExt::updateMassAndInertia(*actor, element.density);
+				}
+				else
+				{
+					float mass = element.density * 4.f / 3.f * physx::PxPi * size.x * size.x * size.x;
+					actor->setMass(mass);
+					actor->setMassSpaceInertiaTensor(physx::PxVec3(0.4f * mass * size.x * size.x));
+				}
+			}
+			actor->setActorFlag(physx::PxActorFlag::eSEND_SLEEP_NOTIFIES, true);
+			rigidbodyDynamic.push_back(actor);
+			actors.push_back(actor);
+			break;
+		}
+		case SceneElementType::StaticBox:
+		{
+			physx::PxRigidStatic* actor = pPhysics->createRigidStatic(physx::PxTransform(position));
+			const SharedShape* shared = shareShapes ? shapeRegistry.acquire(physx::PxBoxGeometry(size), material) : nullptr;
+			if (shared)
+				actor->attachShape(*shared->shape);
+			else
+				physx::PxRigidActorExt::createExclusiveShape(*actor, physx::PxBoxGeometry(size), material);
+			rigidbodyStatic.push_back(actor);
+			actors.push_back(actor);
+			break;
+		}
+		case SceneElementType::Stack:
+			//Columns along x, rows along y, "position" is the centre of the bottom left box.
+			for (uint32_t i = 0; i < element.counts[1]; i++)
+			{
+				for (uint32_t j = 0; j < element.counts[0]; j++)
+					addBox(position + physx::PxVec3(j * 2.f * size.x, i * 2.f * size.y, 0.f), size, element.density, material);
+			}
+			break;
+		case SceneElementType::Pyramid:
+			//Every row is one box shorter and shifted by half a box.
+			for (uint32_t i = 0; i < element.counts[0]; i++)
+			{
+				for (uint32_t j = 0; j < element.counts[0] - i; j++)
+					addBox(position + physx::PxVec3((j * 2.f + i) * size.x, i * 2.f * size.y, 0.f), size, element.density, material);
+			}
+			break;
+		case SceneElementType::Grid:
+			for (uint32_t i = 0; i < element.counts[0]; i++)
+			{
+				for (uint32_t j = 0; j < element.counts[1]; j++)
+				{
+					for (uint32_t k = 0; k < element.counts[2]; k++)
+						addBox(position + physx::PxVec3((float)i, (float)j, (float)k) * element.spacing, size, element.density, material);
+				}
+			}
+			break;
+		case SceneElementType::Trigger:
+		{
+			physx::PxRigidStatic* actor = pPhysics->createRigidStatic(physx::PxTransform(position));
+			physx::PxShape* shape = physx::PxRigidActorExt::createExclusiveShape(*actor, physx::PxBoxGeometry(size), material);
+			shape->setFlag(physx::PxShapeFlag::eSIMULATION_SHAPE, false);
+			shape->setFlag(physx::PxShapeFlag::eTRIGGER_SHAPE, true);
+			if (!pTriggerActor)
+				pTriggerActor = actor;
+			actors.push_back(actor);
+			break;
+		}
+		case SceneElementType::Camera:
+			cameraRadius = size.x;
+			break;
+		}
+	}
+
+	if (!pCameraActor)
+	{
+		pCameraActor = createCameraActor(cameraRadius);
+		actors.push_back(pCameraActor);
+	}
+
+	//One bulk insertion instead of an addActor() call per body.
+	pScene->addActors(actors.data(), (physx::PxU32)actors.size());
+	setupBroadPhaseRegions();
+
+	//Actors hold their own references, the creation references are dropped.
+	for (physx::PxMaterial* material : materials)
+		material->release();
+}
+
+bool PhysicsWorld::saveSnapshot(const std::string& path)
+{
+	//Scene must not be read while a step is running.
+	endStep(true);
+
+	if (!pSerializationRegistry)
+		pSerializationRegistry = physx::PxSerialization::createSerializationRegistry(*pPhysics);
+
+	physx::PxCollection* collection = PxCreateCollection();
+	if (pCameraActor)
+		collection->add(*pCameraActor, makeSnapshotId(SnapshotRole::Camera, 0u));
+	if (pTriggerActor)
+		collection->add(*pTriggerActor, makeSnapshotId(SnapshotRole::Trigger, 0u));
+	for (size_t i = 0; i < rigidbodyDynamic.size(); i++)
+		collection->add(*rigidbodyDynamic[i], makeSnapshotId(SnapshotRole::Dynamic, i));
+	for (size_t i = 0; i < rigidbodyStatic.size(); i++)
+		collection->add(*rigidbodyStatic[i], makeSnapshotId(SnapshotRole::Static, i));
+
+	//Remaining actors are planes and extra triggers. Projectiles belong to the running session and are skipped.
+	std::unordered_set<physx::PxActor*> projectiles(projectileDynamic.begin(), projectileDynamic.end());
+	physx::PxActorTypeFlags actorTypes = physx::PxActorTypeFlag::eRIGID_STATIC | physx::PxActorTypeFlag::eRIGID_DYNAMIC;
+	std::vector<physx::PxActor*> sceneActors(pScene->getNbActors(actorTypes));
+	pScene->getActors(actorTypes, sceneActors.data(), (physx::PxU32)sceneActors.size());
+	size_t otherCount = 0u;
+	for (physx::PxActor* actor : sceneActors)
+	{
+		if (!collection->contains(*actor) && projectiles.find(actor) == projectiles.end())
+			collection->add(*actor, makeSnapshotId(SnapshotRole::Other, otherCount++));
+	}
+
+	//Shapes and materials are pulled in without ids, they are only reached through their actors.
+	physx::PxSerialization::complete(*collection, *pSerializationRegistry);
+
+	bool saved = false;
+	if (!physx::PxSerialization::isSerializable(*collection, *pSerializationRegistry))
+	{
+		printf("ERROR: Scene contains objects that cannot be serialized.\n");
+	}
+	else
+	{
+		physx::PxDefaultFileOutputStream stream(path.c_str());
+		if (!stream.isValid())
+			printf("ERROR: Snapshot could not be written: %s\n", path.c_str());
+		else
+			saved = physx::PxSerialization::serializeCollectionToBinary(stream, *collection, *pSerializationRegistry);
+	}
+
+	collection->release();
+	return saved;
+}
+
+bool PhysicsWorld::loadSnapshot(const std::string& path)
+{
+	endStep(true);
+
+	if (pScene->getNbActors(physx::PxActorTypeFlag::eRIGID_STATIC | physx::PxActorTypeFlag::eRIGID_DYNAMIC) != 0u)
+	{
+		printf("ERROR: Snapshot can only be loaded into an empty scene.\n");
+		return false;
+	}
+
+	//PhysX patches pointers inside the block, so it is mapped copy on write. Mappings are page aligned,
+	//which satisfies PX_SERIAL_FILE_ALIGN without copying the file into an aligned buffer.
+	if (!snapshotFile.open(path, true))
+	{
+		printf("ERROR: Snapshot could not be opened: %s\n", path.c_str());
+		return false;
+	}
+	unsigned char* memory = snapshotFile.mutableData();
+	if (reinterpret_cast<uintptr_t>(memory) % PX_SERIAL_FILE_ALIGN != 0u)
+	{
+		printf("ERROR: Snapshot mapping is not %d byte aligned.\n", PX_SERIAL_FILE_ALIGN);
+		snapshotFile.close();
+		return false;
+	}
+
+	if (!pSerializationRegistry)
+		pSerializationRegistry = physx::PxSerialization::createSerializationRegistry(*pPhysics);
+
+	physx::PxCollection* collection = physx::PxSerialization::createCollectionFromBinary(memory, *pSerializationRegistry);
+	if (!collection)
+	{
+		printf("ERROR: Snapshot is not a valid PhysX binary collection: %s\n", path.c_str());
+		snapshotFile.close();
+		return false;
+	}
+
+	pScene->addCollection(*collection);
+
+	//Rebuild tracking containers in their saved order from the object ids.
+	std::vector<physx::PxRigidDynamic*> dynamics;
+	std::vector<physx::PxRigidStatic*> statics;
+	for (physx::PxU32 i = 0; i < collection->getNbObjects(); i++)
+	{
+		physx::PxBase& object = collection->getObject(i);
+		physx::PxSerialObjectId id = collection->getId(object);
+		physx::PxRigidActor* actor = object.is<physx::PxRigidActor>();
+		if (id == PX_SERIAL_OBJECT_ID_INVALID || !actor)
+			continue;
+
+		//Render slots of the saving session are meaningless now.
+		actor->userData = nullptr;
+
+		size_t index = (size_t)(id & 0xffffffffu);
+		switch ((SnapshotRole)(id >> 32))
+		{
+		case SnapshotRole::Camera:
+		{
+			pCameraActor = actor->is<physx::PxRigidDynamic>();
+			//Snapshots written before scene queries were used keep the camera sphere queryable.
+			physx::PxShape* shape = nullptr;
+			if (pCameraActor && pCameraActor->getShapes(&shape, 1u) == 1u)
+				shape->setFlag(physx::PxShapeFlag::eSCENE_QUERY_SHAPE, false);
+			break;
+		}
+		case SnapshotRole::Trigger:
+			pTriggerActor = actor->is<physx::PxRigidStatic>();
+			break;
+		case SnapshotRole::Dynamic:
+			if (index >= dynamics.size())
+				dynamics.resize(index + 1u, nullptr);
+			dynamics[index] = actor->is<physx::PxRigidDynamic>();
+			break;
+		case SnapshotRole::Static:
+			if (index >= statics.size())
+				statics.resize(index + 1u, nullptr);
+			statics[index] = actor->is<physx::PxRigidStatic>();
+			break;
+		default:
+			break;
+		}
+	}
+	collection->release();
+
+	//Snapshots written before sleep notifications were used lack the flag.
+	for (physx::PxRigidDynamic* actor : dynamics)
+	{
+		if (!actor)
+			continue;
+		actor->setActorFlag(physx::PxActorFlag::eSEND_SLEEP_NOTIFIES, true);
+		rigidbodyDynamic.push_back(actor);
+	}
+	for (physx::PxRigidStatic* actor : statics)
+	{
+		if (actor)
+			rigidbodyStatic.push_back(actor);
+	}
+
+	if (!pCameraActor)
+	{
+		pCameraActor = createCameraActor(0.3f);
+		pScene->addActor(*pCameraActor);
+	}
+	setupBroadPhaseRegions();
+
+	return true;
+}
+
+void PhysicsWorld::step()
+{
+	beginStep();
+	endStep(true);
+}
+
+void PhysicsWorld::beginStep()
+{
+	pScene->simulate(physx::PxReal(pPhysicsStepSize));
+	stepping = true;
+}
+
+bool PhysicsWorld::endStep(bool block)
+{
+	if (!stepping)
+		return true;
+
+	if (!pScene->fetchResults(block))
+		return false;
+
+	stepping = false;
+	if (physxProfiler)
+		physxProfiler->endStep();
+	return true;
+}
+
+bool PhysicsWorld::isStepping() const
+{
+	return stepping;
+}
+
+void PhysicsWorld::release()
+{
+	rigidbodyDynamic.clear();
+	projectileDynamic.clear();
+	rigidbodyStatic.clear();
+
+	if (pScene)
+	{
+		//Scene cannot be released while a step is running.
+		endStep(true);
+		pScene->release();
+		pScene = nullptr;
+	}
+	if (pDispatcher)
+	{
+		pDispatcher->release();
+		pDispatcher = nullptr;
+	}
+	//Actors are gone with the scene, this drops the last shape references.
+	shapeRegistry.release();
+	if (pSerializationRegistry)
+	{
+		pSerializationRegistry->release();
+		pSerializationRegistry = nullptr;
+	}
+	if (pPhysics)
+	{
+		pPhysics->release();
+		pPhysics = nullptr;
+	}
+	snapshotFile.close();
+	if (pFoundation)
+	{
+		pFoundation->release();
+		pFoundation = nullptr;
+	}
+
+	pMaterial = nullptr;
+	pCameraActor = nullptr;
+	pTriggerActor = nullptr;
+}
+
+physx::PxRigidDynamic* PhysicsWorld::createSphereProjectile(const physx::PxVec3& position, const physx::PxVec3& velocity)
+{
+	physx::PxTransform t = physx::PxTransform(position);
+	physx::PxSphereGeometry g = physx::PxSphereGeometry(1.f);
+	physx::PxRigidDynamic* actor = pPhysics->createRigidDynamic(t);
+	ShapeRegistry::attach(*actor, *shapeRegistry.acquire(g, *pMaterial), physx::PxReal(1.f));
+	actor->setActorFlag(physx::PxActorFlag::eSEND_SLEEP_NOTIFIES, true);
+	//Fast projectiles are the only bodies that can tunnel through a box within one step.
+	if (sceneConfig.ccd)
+		actor->setRigidBodyFlag(physx::PxRigidBodyFlag::eENABLE_CCD, true);
+	actor->setLinearVelocity(velocity);
+
+	return actor;
+}
+
+void PhysicsWorld::releaseDynamic(physx::PxRigidDynamic* actor)
+{
+	for (std::vector<physx::PxRigidDynamic*>* list : { &rigidbodyDynamic, &projectileDynamic })
+	{
+		for (size_t i = 0; i < list->size(); i++)
+		{
+			if ((*list)[i] == actor)
+			{
+				(*list)[i] = list->back();
+				list->pop_back();
+				break;
+			}
+		}
+	}
+
+	actor->release();
+}
+
+void PhysicsWorld::releaseDynamics(const std::vector<physx::PxRigidDynamic*>& actors)
+{
+	if (actors.empty())
+		return;
+
+	//One pass over each tracking vector instead of a linear search per actor.
+	std::unordered_set<physx::PxRigidDynamic*> released(actors.begin(), actors.end());
+	for (std::vector<physx::PxRigidDynamic*>* list : { &rigidbodyDynamic, &projectileDynamic })
+	{
+		list->erase(std::remove_if(list->begin(), list->end(), [&released](physx::PxRigidDynamic* actor)
+		{
+			return released.count(actor) != 0u;
+		}), list->end());
+	}
+
+	for (physx::PxRigidDynamic* actor : released)
+		actor->release();
+}
+
+physx::PxRigidDynamic* PhysicsWorld::createCameraActor(float radius)
+{
+	physx::PxRigidDynamic* actor = pPhysics->createRigidDynamic(physx::PxTransform(physx::PxVec3(0.f)));
+	physx::PxShape* shape = physx::PxRigidActorExt::createExclusiveShape(*actor, physx::PxSphereGeometry(radius), *pMaterial);
+	//Camera rays start inside the sphere, it would be the first hit of every one of them.
+	shape->setFlag(physx::PxShapeFlag::eSCENE_QUERY_SHAPE, false);
+	actor->setRigidBodyFlag(physx::PxRigidBodyFlag::eKINEMATIC, true);
+
+	return actor;
+}
+
+void PhysicsWorld::setupBroadPhaseRegions()
+{
+	if (sceneConfig.broadPhase != physx::PxBroadPhaseType::eMBP || pScene->getNbBroadPhaseRegions() > 0u)
+		return;
+
+	//Planes are unbounded and overlap every region, so only bodies decide the world bounds.
+	physx::PxBounds3 worldBounds = physx::PxBounds3::empty();
+	for (physx::PxRigidDynamic* actor : rigidbodyDynamic)
+		worldBounds.include(actor->getWorldBounds());
+	for (physx::PxRigidStatic* actor : rigidbodyStatic)
+		worldBounds.include(actor->getWorldBounds());
+	if (worldBounds.isEmpty())
+		worldBounds = physx::PxBounds3(physx::PxVec3(0.f), physx::PxVec3(0.f));
+
+	//Bodies that leave every region drop out of the broadphase, the margin leaves room for collapsing stacks and projectiles.
+	physx::PxVec3 margin(sceneConfig.mbpMargin);
+	worldBounds = physx::PxBounds3(worldBounds.minimum - margin, worldBounds.maximum + margin);
+
+	std::vector<physx::PxBounds3> regionBounds(sceneConfig.mbpSubdivisions * sceneConfig.mbpSubdivisions);
+	physx::PxU32 regionCount = physx::PxBroadPhaseExt::createRegionsFromWorldBounds(regionBounds.data(), worldBounds, sceneConfig.mbpSubdivisions);
+	for (physx::PxU32 i = 0; i < regionCount; i++)
+	{
+		physx::PxBroadPhaseRegion region;
+		region.bounds = regionBounds[i];
+		region.userData = nullptr;
+		pScene->addBroadPhaseRegion(region, true);
+	}
+}
+
+physx::PxPhysics* PhysicsWorld::getPhysics() const
+{
+	return pPhysics;
+}
+
+physx::PxScene* PhysicsWorld::getScene() const
+{
+	return pScene;
+}
+
+physx::PxMaterial* PhysicsWorld::getMaterial() const
+{
+	return pMaterial;
+}
+
+physx::PxRigidDynamic* PhysicsWorld::getCameraActor() const
+{
+	return pCameraActor;
+}
+
+physx::PxRigidStatic* PhysicsWorld::getTriggerActor() const
+{
+	return pTriggerActor;
+}
+
+void PhysicsWorld::setPhysXProfiler(PhysXProfiler* profiler)
+{
+	physxProfiler = profiler;
+}
+
+void PhysicsWorld::setShapeSharing(bool enabled)
+{
+	shareShapes = enabled;
+}
+
+void PhysicsWorld::setMassIntegration(bool enabled)
+{
+	integrateMass = enabled;
+}
+
+const ShapeRegistry& PhysicsWorld::getShapeRegistry() const
+{
+	return shapeRegistry;
+}
+
+size_t PhysicsWorld::getAllocatedBytes() const
+{
+	return pAllocator.getLiveBytes();
+}
+
+CollisionCallback& PhysicsWorld::getCollisionCallback()
+{
+	return collisionCallback;
+}
+
+void PhysicsWorld::setSceneConfig(const SceneConfig& config)
+{
+	sceneConfig = config;
+}
+
+const SceneConfig& PhysicsWorld::getSceneConfig() const
+{
+	return sceneConfig;
+}
+
+std::vector<physx::PxRigidDynamic*>& PhysicsWorld::getRigidbodyDynamic()
+{
+	return rigidbodyDynamic;
+}
+
+std::vector<physx::PxRigidDynamic*>& PhysicsWorld::getProjectileDynamic()
+{
+	return projectileDynamic;
+}
+
+const std::vector<physx::PxRigidStatic*>& PhysicsWorld::getRigidbodyStatic() const
+{
+	return rigidbodyStatic;
+}
@@ -0,0 +1,22 @@
+#include "PoolCpuDispatcher.h"
+
+PoolCpuDispatcher::PoolCpuDispatcher(ThreadPool& threadPool) :
+	pool(threadPool)
+{
+}
+
+void PoolCpuDispatcher::submitTask(physx::PxBaseTask& task)
+{
+	//Same contract as PxDefaultCpuDispatcher: run the task, then release it so dependents are scheduled.
+	physx::PxBaseTask* pTask = &task;
+	pool.submit([pTask]()
+	{
+		pTask->run();
+		pTask->release();
+	});
+}
+
+physx::PxU32 PoolCpuDispatcher::getWorkerCount() const
+{
+	return pool.getWorkerCount();
+}
@@ -0,0 +1,109 @@
+#include "ProjectilePool.h"
+
+ProjectilePool::ProjectilePool() :
+	spawnCounter(0u),
+	recycledCount(0u)
+{
+}
+
+void ProjectilePool::initialise(PhysicsWorld& world, unsigned int capacity)
+{
+	projectiles.reserve(capacity);
+	active.reserve(capacity);
+	freeList.reserve(capacity);
+
+	for (unsigned int i = 0; i < capacity; i++)
+	{
+		//Park inactive projectiles far below the ground plane.
+		physx::PxRigidDynamic* actor = world.createSphereProjectile(physx::PxVec3(0.f, -1000.f - 3.f * i, 0.f), physx::PxVec3(0.f));
+		actor->setActorFlag(physx::PxActorFlag::eDISABLE_SIMULATION, true);
+		world.getScene()->addActor(*actor);
+		world.getProjectileDynamic().push_back(actor);
+
+		projectiles.push_back({ actor, 0u });
+		freeList.push_back(capacity - 1u - i);
+	}
+}
+
+physx::PxRigidDynamic* ProjectilePool::spawn(const physx::PxVec3& position, const physx::PxVec3& velocity, TransformCache& cache)
+{
+	if (projectiles.empty())
+		return nullptr;
+
+	if (freeList.empty())
+	{
+		//Recycle the projectile that was fired first.
+		unsigned int oldest = 0u;
+		for (unsigned int i = 1; i < active.size(); i++)
+		{
+			if (projectiles[active[i]].spawnId < projectiles[active[oldest]].spawnId)
+				oldest = i;
+		}
+		deactivate(oldest, cache);
+		recycledCount++;
+	}
+
+	unsigned int slot = freeList.back();
+	freeList.pop_back();
+
+	Projectile& projectile = projectiles[slot];
+	projectile.spawnId = spawnCounter++;
+	active.push_back(slot);
+
+	//Velocities can only be set once simulation is enabled again.
+	physx::PxRigidDynamic* actor = projectile.actor;
+	actor->setActorFlag(physx::PxActorFlag::eDISABLE_SIMULATION, false);
+	actor->setGlobalPose(physx::PxTransform(position));
+	actor->setLinearVelocity(velocity);
+	actor->setAngularVelocity(physx::PxVec3(0.f));
+
+	cache.addBody(actor, BodyMesh::Sphere);
+	return actor;
+}
+
+unsigned int ProjectilePool::cull(const physx::PxVec3& viewPos, float threshold, TransformCache& cache)
+{
+	unsigned int culled = 0u;
+	float thresholdSquared = threshold * threshold;
+
+	//Iterate backwards so swap and pop removal does not skip any projectile.
+	for (unsigned int i = (unsigned int)active.size(); i-- > 0;)
+	{
+		const physx::PxTransform& pose = cache.getPose(projectiles[active[i]].actor);
+		if ((pose.p - viewPos).magnitudeSquared() > thresholdSquared)
+		{
+			deactivate(i, cache);
+			culled++;
+		}
+	}
+
+	return culled;
+}
+
+unsigned int ProjectilePool::getActiveCount() const
+{
+	return (unsigned int)active.size();
+}
+
+unsigned int ProjectilePool::getCapacity() const
+{
+	return (unsigned int)projectiles.size();
+}
+
+unsigned long long ProjectilePool::getRecycledCount() const
+{
+	return recycledCount;
+}
+
+void ProjectilePool::deactivate(unsigned int activeIndex, TransformCache& cache)
+{
+	unsigned int slot = active[activeIndex];
+	unsigned int last = (unsigned int)active.size() - 1u;
+	active[activeIndex] = active[last];
+	active.pop_back();
+
+	physx::PxRigidDynamic* actor = projectiles[slot].actor;
+	cache.removeBody(actor);
+	actor->setActorFlag(physx::PxActorFlag::eDISABLE_SIMULATION, true);
+	freeList.push_back(slot);
+}
@@ -0,0 +1,105 @@
+#include "SceneConfig.h"
+
+#include <cstdio>
+#include <cstring>
+
+template<typename Enum>
+struct NamedValue
+{
+	const char* name;
+	const char* label;
+	Enum value;
+};
+
+static const NamedValue<physx::PxBroadPhaseType::Enum> broadPhaseNames[] =
+{
+	{ "sap", "SAP", physx::PxBroadPhaseType::eSAP },
+	{ "mbp", "MBP", physx::PxBroadPhaseType::eMBP },
+	{ "abp", "ABP", physx::PxBroadPhaseType::eABP },
+	{ "pabp", "PABP", physx::PxBroadPhaseType::ePABP }
+};
+
+static const NamedValue<physx::PxSolverType::Enum> solverNames[] =
+{
+	{ "pgs", "PGS", physx::PxSolverType::ePGS },
+	{ "tgs", "TGS", physx::PxSolverType::eTGS }
+};
+
+static const NamedValue<physx::PxFrictionType::Enum> frictionNames[] =
+{
+	{ "patch", "patch", physx::PxFrictionType::ePATCH },
+	{ "one", "one-dir", physx::PxFrictionType::eONE_DIRECTIONAL },
+	{ "two", "two-dir", physx::PxFrictionType::eTWO_DIRECTIONAL }
+};
+
+template<typename Enum, size_t count>
+static bool parseNamedValue(const NamedValue<Enum>(&names)[count], const char* option, const char* name, Enum& value)
+{
+	for (const NamedValue<Enum>& named : names)
+	{
+		if (std::strcmp(named.name, name) == 0)
+		{
+			value = named.value;
+			return true;
+		}
+	}
+
+	printf("ERROR: unknown %s \"%s\".\n", option, name);
+	return false;
+}
+
+template<typename Enum, size_t count>
+static const char* getLabel(const NamedValue<Enum>(&names)[count], Enum value)
+{
+	for (const NamedValue<Enum>& named : names)
+	{
+		if (named.value == value)
+			return named.label;
+	}
+
+	return "?";
+}
+
+SceneConfig::SceneConfig() :
+	mbpMargin(200.f),
+	mbpSubdivisions(4u)
+{
+	physx::PxSceneDesc defaults((physx::PxTolerancesScale()));
+	broadPhase = defaults.broadPhaseType;
+	solver = defaults.solverType;
+	friction = defaults.frictionType;
+	pcm = defaults.flags.isSet(physx::PxSceneFlag::eENABLE_PCM);
+	stabilization = defaults.flags.isSet(physx::PxSceneFlag::eENABLE_STABILIZATION);
+	ccd = defaults.flags.isSet(physx::PxSceneFlag::eENABLE_CCD);
+}
+
+std::string SceneConfig::getName() const
+{
+	std::string name = getLabel(broadPhaseNames, broadPhase);
+	name += " ";
+	name += getLabel(solverNames, solver);
+	name += " ";
+	name += getLabel(frictionNames, friction);
+	if (pcm)
+		name += " pcm";
+	if (stabilization)
+		name += " stab";
+	if (ccd)
+		name += " ccd";
+	return name;
+}
+
+bool parseBroadPhaseType(const char* name, physx::PxBroadPhaseType::Enum& value)
+{
+	return parseNamedValue(broadPhaseNames, "broadphase", name, value);
+}
+
+bool parseSolverType(const char* name, physx::PxSolverType::Enum& value)
+{
+	return parseNamedValue(solverNames, "solver", name, value);
+}
+
+bool parseFrictionType(const char* name, physx::PxFrictionType::Enum& value)
+{
+	return parseNamedValue(frictionNames, "friction type", name, value);
+}
@@ -0,0 +1,388 @@
+#include "SceneDescription.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include "MappedFile.h"
+
+struct SceneFileHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t materialCount;
+	uint32_t elementCount;
+};
+
+static const char sceneFileMagic[4] = { 'P', 'X', 'S', 'C' };
+static constexpr uint32_t sceneFileVersion = 1u;
+//Upper bound of the bodies one stack, pyramid or grid may expand to, a typo must not allocate billions of actors.
+static constexpr uint64_t maxElementActorCount = 1u << 24;
+
+SceneDescription::SceneDescription()
+{
+	materials.push_back({ 0.5f, 0.5f, 0.5f });
+}
+
+size_t SceneDescription::getActorCount() const
+{
+	size_t count = 0u;
+	bool hasCamera = false;
+	for (const SceneElement& element : elements)
+	{
+		switch (element.type)
+		{
+		case SceneElementType::Stack:
+			count += (size_t)element.counts[0] * element.counts[1];
+			break;
+		case SceneElementType::Pyramid:
+			count += (size_t)element.counts[0] * (element.counts[0] + 1u) / 2u;
+			break;
+		case SceneElementType::Grid:
+			count += (size_t)element.counts[0] * element.counts[1] * element.counts[2];
+			break;
+		case SceneElementType::Camera:
+			hasCamera = true;
+			count++;
+			break;
+		default:
+			count++;
+			break;
+		}
+	}
+
+	return hasCamera ? count : count + 1u;
+}
+
+//Splits a line into whitespace separated tokens, comments are dropped.
+static void tokenize(const char* begin, const char* end, std::vector<std::string>& tokens)
+{
+	tokens.clear();
+	const char* current = begin;
+	while (current < end)
+	{
+		while (current < end && (*current == ' ' || *current == '\t' || *current == '\r'))
+			current++;
+		if (current >= end || *current == '#')
+			break;
+
+		const char* tokenBegin = current;
+		while (current < end && *current != ' ' && *current != '\t' && *current != '\r' && *current != '#')
+			current++;
+		tokens.emplace_back(tokenBegin, current);
+	}
+}
+
+static bool parseFloat(const std::string& token, float& value)
+{
+	char* end = nullptr;
+	value = std::strtof(token.c_str(), &end);
+	return end != token.c_str() && *end == '\0';
+}
+
+//Counts come from floats in text files, anything but a whole number in [0, maxElementActorCount] is rejected before the cast.
+static bool toCount(float value, uint32_t& count)
+{
+	if (!std::isfinite(value) || value < 0.f || value > (float)maxElementActorCount || value != std::floor(value))
+		return false;
+
+	count = (uint32_t)value;
+	return true;
+}
+
+static bool isPositive(float value)
+{
+	return std::isfinite(value) && value > 0.f;
+}
+
+//Returns why "element" cannot be built, null when it is valid. Shared by text and binary loading.
+static const char* validateElement(const SceneElement& element)
+{
+	for (float value : element.position)
+	{
+		if (!std::isfinite(value))
+			return "position is not finite";
+	}
+
+	for (uint32_t count : element.counts)
+	{
+		if (count > maxElementActorCount)
+			return "element expands to too many bodies";
+	}
+
+	//Every count is at most 2^24 here and partial products are checked, so nothing below overflows 64 bits.
+	uint64_t actorCount = 1u;
+	switch (element.type)
+	{
+	case SceneElementType::Stack:
+		actorCount = (uint64_t)element.counts[0] * element.counts[1];
+		break;
+	case SceneElementType::Pyramid:
+		actorCount = (uint64_t)element.counts[0] * ((uint64_t)element.counts[0] + 1u) / 2u;
+		break;
+	case SceneElementType::Grid:
+		if (!isPositive(element.spacing))
+			return "spacing must be finite and greater than zero";
+		actorCount = (uint64_t)element.counts[0] * element.counts[1];
+		if (actorCount > maxElementActorCount)
+			return "element expands to too many bodies";
+		actorCount *= element.counts[2];
+		break;
+	default:
+		break;
+	}
+	if (actorCount > maxElementActorCount)
+		return "element expands to too many bodies";
+
+	switch (element.type)
+	{
+	case SceneElementType::Plane:
+		return nullptr;
+	case SceneElementType::Box:
+	case SceneElementType::StaticBox:
+	case SceneElementType::Trigger:
+		if (!isPositive(element.size[0]) || !isPositive(element.size[1]) || !isPositive(element.size[2]))
+			return "size must be finite and greater than zero";
+		break;
+	default:
+		if (!isPositive(element.size[0]))
+			return "size must be finite and greater than zero";
+		break;
+	}
+
+	bool hasDensity = element.type == SceneElementType::Box || element.type == SceneElementType::Sphere || element.type == SceneElementType::Stack ||
+		element.type == SceneElementType::Pyramid || element.type == SceneElementType::Grid;
+	if (hasDensity && !isPositive(element.density))
+		return "density must be finite and greater than zero";
+
+	return nullptr;
+}
+
+bool parseSceneText(const std::string& text, SceneDescription& description, const std::string& sourceName)
+{
+	//Required numeric argument count of each keyword, optional density / material follow.
+	struct Keyword
+	{
+		SceneElementType type;
+		unsigned int numberCount;
+		bool hasDensity;
+		bool hasMaterial;
+	};
+	static const std::unordered_map<std::string, Keyword> keywords = {
+		{ "plane", { SceneElementType::Plane, 0u, false, true } },
+		{ "box", { SceneElementType::Box, 6u, true, true } },
+		{ "sphere", { SceneElementType::Sphere, 4u, true, true } },
+		{ "static_box", { SceneElementType::StaticBox, 6u, false, true } },
+		{ "stack", { SceneElementType::Stack, 6u, true, true } },
+		{ "pyramid", { SceneElementType::Pyramid, 5u, true, true } },
+		{ "grid", { SceneElementType::Grid, 8u, true, true } },
+		{ "trigger", { SceneElementType::Trigger, 6u, false, false } },
+		{ "camera", { SceneElementType::Camera, 1u, false, false } }
+	};
+
+	std::unordered_map<std::string, uint32_t> materialIndices = { { "default", 0u } };
+	std::vector<std::string> tokens;
+	float numbers[8];
+
+	unsigned int lineNumber = 0u;
+	const char* current = text.data();
+	const char* end = current + text.size();
+	while (current < end)
+	{
+		const char* lineEnd = static_cast<const char*>(std::memchr(current, '\n', (size_t)(end - current)));
+		if (!lineEnd)
+			lineEnd = end;
+		lineNumber++;
+		tokenize(current, lineEnd, tokens);
+		current = lineEnd + 1;
+
+		if (tokens.empty())
+			continue;
+
+		if (tokens[0] == "material")
+		{
+			SceneMaterial material;
+			if (tokens.size() != 5u || !parseFloat(tokens[2], material.staticFriction) ||
+				!parseFloat(tokens[3], material.dynamicFriction) || !parseFloat(tokens[4], material.restitution))
+			{
+				printf("ERROR: %s line %u: expected \"material <name> <static friction> <dynamic friction> <restitution>\".\n", sourceName.c_str(), lineNumber);
+				return false;
+			}
+			materialIndices[tokens[1]] = (uint32_t)description.materials.size();
+			description.materials.push_back(material);
+			continue;
+		}
+
+		auto keyword = keywords.find(tokens[0]);
+		if (keyword == keywords.end())
+		{
+			printf("ERROR: %s line %u: unknown element \"%s\".\n", sourceName.c_str(), lineNumber, tokens[0].c_str());
+			return false;
+		}
+
+		const Keyword& format = keyword->second;
+		if (tokens.size() < 1u + format.numberCount)
+		{
+			printf("ERROR: %s line %u: \"%s\" needs %u numbers.\n", sourceName.c_str(), lineNumber, tokens[0].c_str(), format.numberCount);
+			return false;
+		}
+		for (unsigned int i = 0; i < format.numberCount; i++)
+		{
+			if (!parseFloat(tokens[1u + i], numbers[i]))
+			{
+				printf("ERROR: %s line %u: \"%s\" is not a number.\n", sourceName.c_str(), lineNumber, tokens[1u + i].c_str());
+				return false;
+			}
+		}
+
+		SceneElement element = {};
+		element.type = format.type;
+		element.density = 1.f;
+		for (size_t i = 1u + format.numberCount; i < tokens.size(); i++)
+		{
+			float density;
+			if (format.hasDensity && parseFloat(tokens[i], density))
+			{
+				element.density = density;
+				continue;
+			}
+
+			auto material = materialIndices.find(tokens[i]);
+			if (!format.hasMaterial || material == materialIndices.end())
+			{
+				printf("ERROR: %s line %u: unexpected \"%s\".\n", sourceName.c_str(), lineNumber, tokens[i].c_str());
+				return false;
+			}
+			element.material = material->second;
+		}
+
+		//Numbers are laid out as position first, then the keyword specific values.
+		if (format.type != SceneElementType::Plane && format.type != SceneElementType::Camera)
+			std::memcpy(element.position, numbers, sizeof(element.position));
+
+		//Stacks, pyramids and grids carry their counts right after the position.
+		unsigned int countCount = format.type == SceneElementType::Grid ? 3u : (format.type == SceneElementType::Stack ? 2u :
+			(format.type == SceneElementType::Pyramid ? 1u : 0u));
+		for (unsigned int i = 0; i < countCount; i++)
+		{
+			if (!toCount(numbers[3u + i], element.counts[i]))
+			{
+				printf("ERROR: %s line %u: \"%s\" is not a valid count.\n", sourceName.c_str(), lineNumber, tokens[4u + i].c_str());
+				return false;
+			}
+		}
+
+		switch (format.type)
+		{
+		case SceneElementType::Box:
+		case SceneElementType::StaticBox:
+		case SceneElementType::Trigger:
+			std::memcpy(element.size, numbers + 3, sizeof(element.size));
+			break;
+		case SceneElementType::Sphere:
+			element.size[0] = element.size[1] = element.size[2] = numbers[3];
+			break;
+		case SceneElementType::Stack:
+			element.size[0] = element.size[1] = element.size[2] = numbers[5];
+			break;
+		case SceneElementType::Pyramid:
+			element.size[0] = element.size[1] = element.size[2] = numbers[4];
+			break;
+		case SceneElementType::Grid:
+			element.spacing = numbers[6];
+			element.size[0] = element.size[1] = element.size[2] = numbers[7];
+			break;
+		case SceneElementType::Camera:
+			element.size[0] = element.size[1] = element.size[2] = numbers[0];
+			break;
+		default:
+			break;
+		}
+
+		const char* error = validateElement(element);
+		if (error)
+		{
+			printf("ERROR: %s line %u: %s.\n", sourceName.c_str(), lineNumber, error);
+			return false;
+		}
+		description.elements.push_back(element);
+	}
+
+	return true;
+}
+
+static bool loadSceneBinary(const MappedFile& file, const std::string& path, SceneDescription& description)
+{
+	const SceneFileHeader* header = reinterpret_cast<const SceneFileHeader*>(file.data());
+	size_t expectedSize = sizeof(SceneFileHeader) + (size_t)header->materialCount * sizeof(SceneMaterial) + (size_t)header->elementCount * sizeof(SceneElement);
+	if (header->version != sceneFileVersion || header->materialCount == 0u || file.size() < expectedSize)
+	{
+		printf("ERROR: %s is not a valid version %u binary scene.\n", path.c_str(), sceneFileVersion);
+		return false;
+	}
+
+	const SceneMaterial* materials = reinterpret_cast<const SceneMaterial*>(file.data() + sizeof(SceneFileHeader));
+	const SceneElement* elements = reinterpret_cast<const SceneElement*>(materials + header->materialCount);
+	description.materials.assign(materials, materials + header->materialCount);
+	description.elements.assign(elements, elements + header->elementCount);
+
+	for (const SceneElement& element : description.elements)
+	{
+		if (element.material >= header->materialCount || element.type > SceneElementType::Camera)
+		{
+			printf("ERROR: %s contains an invalid element.\n", path.c_str());
+			return false;
+		}
+		const char* error = validateElement(element);
+		if (error)
+		{
+			printf("ERROR: %s contains an invalid element: %s.\n", path.c_str(), error);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool loadSceneDescription(const std::string& path, SceneDescription& description)
+{
+	description = SceneDescription();
+
+	MappedFile file;
+	if (!file.open(path))
+	{
+		printf("ERROR: Scene file could not be opened: %s\n", path.c_str());
+		return false;
+	}
+
+	if (file.size() >= sizeof(SceneFileHeader) && std::memcmp(file.data(), sceneFileMagic, sizeof(sceneFileMagic)) == 0)
+		return loadSceneBinary(file, path, description);
+
+	std::string text(reinterpret_cast<const char*>(file.data()), file.size());
+	return parseSceneText(text, description, path);
+}
+
+bool saveSceneBinary(const std::string& path, const SceneDescription& description)
+{
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	if (!stream)
+	{
+		printf("ERROR: Scene file could not be written: %s\n", path.c_str());
+		return false;
+	}
+
+	SceneFileHeader header;
+	std::memcpy(header.magic, sceneFileMagic, sizeof(sceneFileMagic));
+	header.version = sceneFileVersion;
+	header.materialCount = (uint32_t)description.materials.size();
+	header.elementCount = (uint32_t)description.elements.size();
+
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	stream.write(reinterpret_cast<const char*>(description.materials.data()), (std::streamsize)(description.materials.size() * sizeof(SceneMaterial)));
+	stream.write(reinterpret_cast<const char*>(description.elements.data()), (std::streamsize)(description.elements.size() * sizeof(SceneElement)));
+	return (bool)stream;
+}
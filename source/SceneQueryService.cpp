@@ -0,0 +1,154 @@
+#include "SceneQueryService.h"
+
+#include <chrono>
+
+static QueryHit toQueryHit(const physx::PxLocationHit& hit, bool hasHit)
+{
+	if (!hasHit)
+		return { nullptr, nullptr, physx::PxVec3(0.f), physx::PxVec3(0.f), 0.f };
+
+	return { hit.actor, hit.shape, hit.position, hit.normal, hit.distance };
+}
+
+SceneQueryService::SceneQueryService(ThreadPool& threadPool, unsigned int grainSize) :
+	pool(threadPool),
+	grain(grainSize),
+	lastExecuteTime(0.0),
+	fullOverlapCount(0u)
+{
+}
+
+unsigned int SceneQueryService::addRaycast(const physx::PxVec3& origin, const physx::PxVec3& direction, physx::PxReal distance)
+{
+	std::lock_guard<std::mutex> lock(requestMutex);
+	pendingRaycasts.push_back({ origin, direction, distance });
+	return (unsigned int)pendingRaycasts.size() - 1u;
+}
+
+unsigned int SceneQueryService::addSweep(const physx::PxGeometry& geometry, const physx::PxTransform& pose, const physx::PxVec3& direction, physx::PxReal distance)
+{
+	std::lock_guard<std::mutex> lock(requestMutex);
+	pendingSweeps.push_back({ physx::PxGeometryHolder(geometry), pose, direction, distance });
+	return (unsigned int)pendingSweeps.size() - 1u;
+}
+
+unsigned int SceneQueryService::addOverlap(const physx::PxGeometry& geometry, const physx::PxTransform& pose)
+{
+	std::lock_guard<std::mutex> lock(requestMutex);
+	pendingOverlaps.push_back({ physx::PxGeometryHolder(geometry), pose, physx::PxVec3(0.f), 0.f });
+	return (unsigned int)pendingOverlaps.size() - 1u;
+}
+
+unsigned int SceneQueryService::execute(physx::PxScene* scene)
+{
+	auto executeStart = std::chrono::high_resolution_clock::now();
+	{
+		std::lock_guard<std::mutex> lock(requestMutex);
+		raycasts.swap(pendingRaycasts);
+		sweeps.swap(pendingSweeps);
+		overlaps.swap(pendingOverlaps);
+		pendingRaycasts.clear();
+		pendingSweeps.clear();
+		pendingOverlaps.clear();
+	}
+
+	//Result arrays only grow, workers write disjoint elements of them.
+	raycastHits.resize(raycasts.size());
+	sweepHits.resize(sweeps.size());
+	overlapHitCounts.resize(overlaps.size());
+	if (overlapHits.size() < overlaps.size() * maxOverlapHits)
+		overlapHits.resize(overlaps.size() * maxOverlapHits);
+
+	unsigned int requestCount = (unsigned int)(raycasts.size() + sweeps.size() + overlaps.size());
+	//Pending pruner updates from the fetched step and added or released actors are applied here, once. Otherwise
+	//the first worker to query rebuilds them under the scene's write lock and the others stall behind it.
+	if (requestCount > 0u)
+		scene->flushQueryUpdates();
+	pool.parallelFor(0u, requestCount, grain, [this, scene](unsigned int begin, unsigned int end)
+	{
+		runRange(scene, begin, end);
+	});
+
+	lastExecuteTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - executeStart).count();
+	return requestCount;
+}
+
+void SceneQueryService::runRange(physx::PxScene* scene, unsigned int begin, unsigned int end)
+{
+	//Every reading thread needs its own read lock when the scene has PxSceneFlag::eREQUIRE_RW_LOCK.
+	physx::PxSceneReadLock readLock(*scene);
+
+	unsigned int sweepBegin = (unsigned int)raycasts.size();
+	unsigned int overlapBegin = sweepBegin + (unsigned int)sweeps.size();
+	//Overlaps report every shape as a touch, otherwise the first blocking shape would end the query.
+	const physx::PxQueryFilterData overlapFilter(physx::PxQueryFlag::eSTATIC | physx::PxQueryFlag::eDYNAMIC | physx::PxQueryFlag::eNO_BLOCK);
+
+	for (unsigned int i = begin; i < end; i++)
+	{
+		if (i < sweepBegin)
+		{
+			const RaycastRequest& request = raycasts[i];
+			physx::PxRaycastBuffer hit;
+			bool hasHit = scene->raycast(request.origin, request.direction, request.distance, hit);
+			raycastHits[i] = toQueryHit(hit.block, hasHit && hit.hasBlock);
+		}
+		else if (i < overlapBegin)
+		{
+			const ShapeRequest& request = sweeps[i - sweepBegin];
+			physx::PxSweepBuffer hit;
+			bool hasHit = scene->sweep(request.geometry.any(), request.pose, request.direction, request.distance, hit);
+			sweepHits[i - sweepBegin] = toQueryHit(hit.block, hasHit && hit.hasBlock);
+		}
+		else
+		{
+			unsigned int index = i - overlapBegin;
+			const ShapeRequest& request = overlaps[index];
+			physx::PxOverlapBuffer hits(&overlapHits[(size_t)index * maxOverlapHits], maxOverlapHits);
+			scene->overlap(request.geometry.any(), request.pose, hits, overlapFilter);
+			overlapHitCounts[index] = hits.getNbTouches();
+			if (overlapHitCounts[index] == maxOverlapHits)
+				fullOverlapCount.fetch_add(1u, std::memory_order_relaxed);
+		}
+	}
+}
+
+unsigned int SceneQueryService::getRaycastCount() const
+{
+	return (unsigned int)raycasts.size();
+}
+
+unsigned int SceneQueryService::getSweepCount() const
+{
+	return (unsigned int)sweeps.size();
+}
+
+unsigned int SceneQueryService::getOverlapCount() const
+{
+	return (unsigned int)overlaps.size();
+}
+
+const QueryHit& SceneQueryService::getRaycastHit(unsigned int index) const
+{
+	return raycastHits[index];
+}
+
+const QueryHit& SceneQueryService::getSweepHit(unsigned int index) const
+{
+	return sweepHits[index];
+}
+
+const physx::PxOverlapHit* SceneQueryService::getOverlapHits(unsigned int index, physx::PxU32& count) const
+{
+	count = overlapHitCounts[index];
+	return &overlapHits[(size_t)index * maxOverlapHits];
+}
+
+double SceneQueryService::getLastExecuteTime() const
+{
+	return lastExecuteTime;
+}
+
+unsigned long long SceneQueryService::getFullOverlapCount() const
+{
+	return fullOverlapCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,113 @@
+#include "ShapeRegistry.h"
+
+#include <cstring>
+#include <functional>
+
+ShapeRegistry::ShapeRegistry() :
+	pPhysics(nullptr),
+	hitCount(0u)
+{
+}
+
+void ShapeRegistry::initialise(physx::PxPhysics* physics)
+{
+	pPhysics = physics;
+}
+
+const SharedShape* ShapeRegistry::acquire(const physx::PxGeometry& geometry, const physx::PxMaterial& material, physx::PxShapeFlags flags)
+{
+	ShapeKey key = { geometry.getType(), { 0.f, 0.f, 0.f }, &material, (physx::PxU32)flags };
+	switch (key.type)
+	{
+	case physx::PxGeometryType::eBOX:
+	{
+		const physx::PxVec3& halfExtents = static_cast<const physx::PxBoxGeometry&>(geometry).halfExtents;
+		key.dimensions[0] = halfExtents.x;
+		key.dimensions[1] = halfExtents.y;
+		key.dimensions[2] = halfExtents.z;
+		break;
+	}
+	case physx::PxGeometryType::eSPHERE:
+		key.dimensions[0] = static_cast<const physx::PxSphereGeometry&>(geometry).radius;
+		break;
+	case physx::PxGeometryType::eCAPSULE:
+		key.dimensions[0] = static_cast<const physx::PxCapsuleGeometry&>(geometry).radius;
+		key.dimensions[1] = static_cast<const physx::PxCapsuleGeometry&>(geometry).halfHeight;
+		break;
+	case physx::PxGeometryType::ePLANE:
+		break;
+	default:
+		return nullptr;
+	}
+
+	auto found = shapes.find(key);
+	if (found != shapes.end())
+	{
+		hitCount++;
+		return &found->second;
+	}
+
+	SharedShape shared = { pPhysics->createShape(geometry, material, false, flags), 0.f, physx::PxVec3(0.f), physx::PxTransform(physx::PxIdentity) };
+	if (!shared.shape)
+		return nullptr;
+
+	//Planes have no volume and can only be attached to static actors.
+	if (key.type != physx::PxGeometryType::ePLANE)
+	{
+		physx::PxMassProperties properties(geometry);
+		physx::PxQuat massRotation;
+		physx::PxVec3 inertia = physx::PxMassProperties::getMassSpaceInertia(properties.inertiaTensor, massRotation);
+		shared.unitMass = properties.mass;
+		shared.unitInertia = properties.mass > 0.f ? inertia * (1.f / properties.mass) : physx::PxVec3(0.f);
+		shared.massFrame = physx::PxTransform(properties.centerOfMass, massRotation);
+	}
+
+	return &shapes.emplace(key, shared).first->second;
+}
+
+void ShapeRegistry::attach(physx::PxRigidDynamic& actor, const SharedShape& shape, physx::PxReal density)
+{
+	actor.attachShape(*shape.shape);
+	physx::PxReal mass = density * shape.unitMass;
+	actor.setMass(mass);
+	actor.setMassSpaceInertiaTensor(shape.unitInertia * mass);
+	actor.setCMassLocalPose(shape.massFrame);
+}
+
+void ShapeRegistry::release()
+{
+	for (auto& entry : shapes)
+		entry.second.shape->release();
+	shapes.clear();
+	pPhysics = nullptr;
+}
+
+unsigned int ShapeRegistry::getShapeCount() const
+{
+	return (unsigned int)shapes.size();
+}
+
+unsigned long long ShapeRegistry::getHitCount() const
+{
+	return hitCount;
+}
+
+bool ShapeRegistry::ShapeKey::operator==(const ShapeKey& other) const
+{
+	return type == other.type && material == other.material && flags == other.flags &&
+		dimensions[0] == other.dimensions[0] && dimensions[1] == other.dimensions[1] && dimensions[2] == other.dimensions[2];
+}
+
+size_t ShapeRegistry::ShapeKeyHash::operator()(const ShapeKey& key) const
+{
+	size_t hash = std::hash<const void*>()(key.material);
+	auto combine = [&hash](size_t value)
+	{
+		hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+	};
+	combine((size_t)key.type);
+	combine((size_t)key.flags);
+	for (physx::PxReal dimension : key.dimensions)
+		combine(std::hash<physx::PxReal>()(dimension));
+	return hash;
+}
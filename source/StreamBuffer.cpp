@@ -0,0 +1,192 @@
+#include "StreamBuffer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static constexpr GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+StreamBuffer::StreamBuffer(size_t regionSize, unsigned int regionCount) :
+	buffer(0u),
+	mappedData(nullptr),
+	regionBytes(0u),
+	regions(regionCount < 2u ? 2u : regionCount),
+	currentRegion(0u),
+	regionOffset(0u),
+	requestedBytes(0u),
+	growRegions(false),
+	uniformAlignment(256u),
+	storageAlignment(256u),
+	lastWaitTime(0.0),
+	totalWaitTime(0.0),
+	waitCount(0u),
+	overflowCount(0u)
+{
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	if (alignment > 0)
+		uniformAlignment = (size_t)alignment;
+	alignment = 0;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	if (alignment > 0)
+		storageAlignment = (size_t)alignment;
+
+	fences.resize(regions, nullptr);
+	create(regionSize);
+}
+
+void StreamBuffer::beginFrame()
+{
+	if (growRegions)
+	{
+		//Mapped memory cannot be resized. Wait until the GPU is done with every region and start over.
+		size_t size = regionBytes;
+		while (size < requestedBytes)
+			size *= 2u;
+		printf("WARNING: Stream buffer regions grown from %zu to %zu KB.\n", regionBytes / 1024u, size / 1024u);
+		destroy();
+		create(size);
+		growRegions = false;
+	}
+
+	currentRegion = (currentRegion + 1u) % regions;
+	regionOffset = 0u;
+	requestedBytes = 0u;
+	lastWaitTime = 0.0;
+
+	GLsync& fence = fences[currentRegion];
+	if (!fence)
+		return;
+
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		auto waitStart = std::chrono::high_resolution_clock::now();
+		do
+		{
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000u);
+		} while (result == GL_TIMEOUT_EXPIRED);
+		lastWaitTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - waitStart).count();
+		totalWaitTime += lastWaitTime;
+		waitCount++;
+	}
+	if (result == GL_WAIT_FAILED)
+		printf("WARNING: Waiting on a stream buffer fence failed.\n");
+
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+void StreamBuffer::endFrame()
+{
+	GLsync& fence = fences[currentRegion];
+	if (fence)
+		glDeleteSync(fence);
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+StreamAllocation StreamBuffer::allocate(size_t size, size_t alignment)
+{
+	size_t offset = (regionOffset + alignment - 1u) & ~(alignment - 1u);
+	requestedBytes = (requestedBytes + alignment - 1u) & ~(alignment - 1u);
+	requestedBytes += size;
+	if (offset + size > regionBytes)
+	{
+		overflowCount++;
+		growRegions = true;
+		return { nullptr, 0u, 0u };
+	}
+
+	regionOffset = offset + size;
+	size_t bufferOffset = currentRegion * regionBytes + offset;
+	return { mappedData + bufferOffset, bufferOffset, size };
+}
+
+void StreamBuffer::release()
+{
+	if (buffer != 0u)
+		destroy();
+}
+
+void StreamBuffer::bindRange(GLenum target, unsigned int index, const StreamAllocation& allocation) const
+{
+	glBindBufferRange(target, index, buffer, (GLintptr)allocation.offset, (GLsizeiptr)allocation.size);
+}
+
+unsigned int StreamBuffer::getBuffer() const
+{
+	return buffer;
+}
+
+size_t StreamBuffer::getUniformAlignment() const
+{
+	return uniformAlignment;
+}
+
+size_t StreamBuffer::getStorageAlignment() const
+{
+	return storageAlignment;
+}
+
+size_t StreamBuffer::getRegionSize() const
+{
+	return regionBytes;
+}
+
+double StreamBuffer::getLastWaitTime() const
+{
+	return lastWaitTime;
+}
+
+double StreamBuffer::getTotalWaitTime() const
+{
+	return totalWaitTime;
+}
+
+unsigned long long StreamBuffer::getWaitCount() const
+{
+	return waitCount;
+}
+
+unsigned long long StreamBuffer::getOverflowCount() const
+{
+	return overflowCount;
+}
+
+void StreamBuffer::create(size_t size)
+{
+	//Keep every region start aligned for any binding target.
+	size_t alignment = uniformAlignment > storageAlignment ? uniformAlignment : storageAlignment;
+	regionBytes = (size + alignment - 1u) & ~(alignment - 1u);
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(regionBytes * regions), nullptr, mapFlags);
+	mappedData = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)(regionBytes * regions), mapFlags));
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (!mappedData)
+	{
+		printf("ERROR: Stream buffer of %zu bytes could not be mapped.\n", regionBytes * regions);
+		std::exit(EXIT_FAILURE);
+	}
+}
+
+void StreamBuffer::destroy()
+{
+	for (GLsync& fence : fences)
+	{
+		if (!fence)
+			continue;
+		glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glDeleteBuffers(1, &buffer);
+	buffer = 0u;
+	mappedData = nullptr;
+}
@@ -0,0 +1,127 @@
+#include "TextureArray.h"
+
+#include <cstdio>
+
+#include "AsyncTextureLoader.h"
+
+TextureArray::TextureArray(int layerSize, unsigned int maxLayerCount) :
+	textureArray(0u),
+	readFramebuffer(0u),
+	drawFramebuffer(0u),
+	size(layerSize),
+	maxLayers(maxLayerCount)
+{
+	int levels = 1;
+	while ((size >> levels) > 0)
+		levels++;
+
+	glGenTextures(1, &textureArray);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, size, size, (GLsizei)maxLayers);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	//Same grey as the AsyncTextureLoader placeholder.
+	static const unsigned char placeholder[4] = { 128, 128, 128, 255 };
+	for (int level = 0; level < levels; level++)
+	{
+		int levelSize = size >> level;
+		glClearTexSubImage(textureArray, level, 0, 0, 0, levelSize, levelSize, 1, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	}
+	layers.push_back({ 0u, true });
+
+	glGenFramebuffers(1, &readFramebuffer);
+	glGenFramebuffers(1, &drawFramebuffer);
+}
+
+unsigned int TextureArray::addLayer(unsigned int textureId)
+{
+	if (textureId == 0u)
+		return 0u;
+
+	auto found = layersByTexture.find(textureId);
+	if (found != layersByTexture.end())
+		return found->second;
+
+	if (layers.size() >= maxLayers)
+	{
+		printf("WARNING: Texture array is full, texture %u uses the placeholder layer.\n", textureId);
+		return 0u;
+	}
+
+	unsigned int layer = (unsigned int)layers.size();
+	layers.push_back({ textureId, false });
+	layersByTexture[textureId] = layer;
+	return layer;
+}
+
+unsigned int TextureArray::update(const AsyncTextureLoader* loader)
+{
+	unsigned int copiedCount = 0u;
+	for (unsigned int i = 1; i < layers.size(); i++)
+	{
+		if (layers[i].copied || (loader && loader->isPending(layers[i].textureId)))
+			continue;
+
+		copyLayer(i);
+		layers[i].copied = true;
+		copiedCount++;
+	}
+
+	if (copiedCount > 0u)
+	{
+		glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+	return copiedCount;
+}
+
+void TextureArray::bind() const
+{
+	glActiveTexture(GL_TEXTURE0 + textureUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void TextureArray::release()
+{
+	if (textureArray == 0u)
+		return;
+
+	glDeleteFramebuffers(1, &readFramebuffer);
+	glDeleteFramebuffers(1, &drawFramebuffer);
+	glDeleteTextures(1, &textureArray);
+	textureArray = readFramebuffer = drawFramebuffer = 0u;
+}
+
+unsigned int TextureArray::getLayerCount() const
+{
+	return (unsigned int)layers.size();
+}
+
+void TextureArray::copyLayer(unsigned int layer)
+{
+	unsigned int source = layers[layer].textureId;
+	GLint width = 0, height = 0;
+	glBindTexture(GL_TEXTURE_2D, source);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFramebuffer);
+	glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, textureArray, 0, (GLint)layer);
+
+	if (glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE && glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE)
+		glBlitFramebuffer(0, 0, width, height, 0, 0, size, size, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	else
+		printf("WARNING: Texture %u could not be copied into texture array layer %u.\n", source, layer);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,147 @@
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <utility>
+
+#include "AsyncTextureLoader.h"
+#include "Utilities.h"
+
+TextureCache& TextureCache::instance()
+{
+	static TextureCache cache;
+	return cache;
+}
+
+TextureCache::TextureCache() :
+	hitCount(0u)
+{
+}
+
+unsigned int TextureCache::acquire(const std::string& path, bool gamma, GLint wrapMode, AsyncTextureLoader* loader)
+{
+	std::string key = normalizePath(path) + (gamma ? "|srgb" : "|linear");
+
+	auto found = idsByKey.find(key);
+	if (found != idsByKey.end())
+	{
+		entries[found->second].referenceCount++;
+		hitCount++;
+		return found->second;
+	}
+
+	unsigned int textureId = loader ? loader->request(path, gamma, wrapMode) : uploadTextureFromFile(path.c_str(), gamma, wrapMode);
+	if (textureId == 0u)
+		return 0u;
+
+	idsByKey.emplace(key, textureId);
+	entries.emplace(textureId, Entry{ key, 1u, loader });
+	return textureId;
+}
+
+void TextureCache::retain(unsigned int textureId)
+{
+	auto found = entries.find(textureId);
+	if (found != entries.end())
+		found->second.referenceCount++;
+}
+
+void TextureCache::release(unsigned int textureId)
+{
+	auto found = entries.find(textureId);
+	if (found == entries.end() || --found->second.referenceCount > 0u)
+		return;
+
+	//A pending decode must not upload into a name that glGenTextures may hand out again.
+	if (found->second.loader)
+		found->second.loader->cancel(textureId);
+
+	glDeleteTextures(1, &textureId);
+	idsByKey.erase(found->second.key);
+	entries.erase(found);
+}
+
+void TextureCache::releaseAll()
+{
+	for (auto& entry : entries)
+	{
+		unsigned int textureId = entry.first;
+		if (entry.second.loader)
+			entry.second.loader->cancel(textureId);
+		glDeleteTextures(1, &textureId);
+	}
+
+	entries.clear();
+	idsByKey.clear();
+}
+
+unsigned int TextureCache::getTextureCount() const
+{
+	return (unsigned int)entries.size();
+}
+
+unsigned long long TextureCache::getHitCount() const
+{
+	return hitCount;
+}
+
+std::string TextureCache::normalizePath(const std::string& path)
+{
+	std::error_code error;
+	std::filesystem::path absolutePath = std::filesystem::absolute(path, error);
+	if (error)
+		absolutePath = path;
+
+	//weakly_canonical resolves "..", "." and links even for files that do not exist yet.
+	std::filesystem::path normalized = std::filesystem::weakly_canonical(absolutePath, error);
+	if (error)
+		normalized = absolutePath.lexically_normal();
+
+	std::string key = normalized.generic_string();
+#ifdef _WIN32
+	//Windows paths are case insensitive.
+	std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+#endif
+	return key;
+}
+
+TextureHandle::TextureHandle() :
+	id(0u)
+{
+}
+
+TextureHandle::TextureHandle(unsigned int textureId) :
+	id(textureId)
+{
+}
+
+TextureHandle::TextureHandle(const TextureHandle& other) :
+	id(other.id)
+{
+	if (id != 0u)
+		TextureCache::instance().retain(id);
+}
+
+TextureHandle::TextureHandle(TextureHandle&& other) noexcept :
+	id(other.id)
+{
+	other.id = 0u;
+}
+
+TextureHandle& TextureHandle::operator=(TextureHandle other) noexcept
+{
+	std::swap(id, other.id);
+	return *this;
+}
+
+TextureHandle::~TextureHandle()
+{
+	if (id != 0u)
+		TextureCache::instance().release(id);
+}
+
+unsigned int TextureHandle::get() const
+{
+	return id;
+}
@@ -0,0 +1,231 @@
+#include "ThreadPool.h"
+
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#endif
+
+//Owning pool and queue index of the current thread, external threads have no owner.
+static thread_local const ThreadPool* currentPool = nullptr;
+static thread_local unsigned int currentWorkerIndex = 0u;
+
+static bool pinThreadToCore(std::thread& thread, unsigned int core)
+{
+#ifdef _WIN32
+	if (core >= sizeof(DWORD_PTR) * 8u)
+		return false;
+	return SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << core) != 0;
+#elif defined(__linux__)
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(core, &cpuSet);
+	return pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuSet) == 0;
+#else
+	return false;
+#endif
+}
+
+ThreadPool::ThreadPool() :
+	pendingJobs(0u),
+	sleepingWorkers(0u),
+	nextQueue(0u),
+	stealCount(0u),
+	running(false)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+	shutdown();
+}
+
+void ThreadPool::initialise(unsigned int workerCount, bool pinToCores, unsigned int firstCore)
+{
+	shutdown();
+
+	queues.clear();
+	for (unsigned int i = 0; i < workerCount; i++)
+		queues.push_back(std::make_unique<WorkerQueue>());
+
+	running = true;
+	unsigned int coreCount = std::thread::hardware_concurrency();
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		workers.emplace_back(&ThreadPool::workerLoop, this, i);
+		if (pinToCores && coreCount > 0u)
+		{
+			unsigned int core = (firstCore + i) % coreCount;
+			if (!pinThreadToCore(workers.back(), core))
+				printf("WARNING: Worker %u could not be pinned to core %u.\n", i, core);
+		}
+	}
+}
+
+void ThreadPool::shutdown()
+{
+	if (workers.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		running = false;
+	}
+	wakeCondition.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+	workers.clear();
+}
+
+void ThreadPool::submit(Job job)
+{
+	if (workers.empty())
+	{
+		job();
+		return;
+	}
+
+	//Workers feed their own queue so nested PhysX tasks stay cache local, others are spread round robin.
+	unsigned int index = currentPool == this ? currentWorkerIndex : nextQueue.fetch_add(1u, std::memory_order_relaxed) % (unsigned int)queues.size();
+	{
+		//Counted before it becomes visible, a worker popping it right away must not wrap the counter below zero.
+		std::lock_guard<std::mutex> lock(queues[index]->mutex);
+		pendingJobs.fetch_add(1u);
+		queues[index]->jobs.push_back(std::move(job));
+	}
+
+	if (sleepingWorkers.load() > 0u)
+	{
+		//Taking the mutex orders this notify after a worker that is about to wait has checked its predicate.
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		wakeCondition.notify_one();
+	}
+}
+
+void ThreadPool::parallelFor(unsigned int begin, unsigned int end, unsigned int grainSize, const std::function<void(unsigned int, unsigned int)>& body)
+{
+	if (end <= begin)
+		return;
+
+	if (grainSize == 0u)
+		grainSize = 1u;
+
+	unsigned int chunkCount = (end - begin + grainSize - 1u) / grainSize;
+	if (chunkCount == 1u || workers.empty())
+	{
+		body(begin, end);
+		return;
+	}
+
+	//Helpers may start after this call returned, so shared counters are reference counted.
+	//A helper only touches "body" while it holds an unfinished chunk, which this call waits for.
+	struct ForState
+	{
+		std::atomic<unsigned int> nextChunk{ 0u };
+		std::atomic<unsigned int> doneChunks{ 0u };
+	};
+	std::shared_ptr<ForState> state = std::make_shared<ForState>();
+	const std::function<void(unsigned int, unsigned int)>* bodyPointer = &body;
+
+	auto runChunks = [state, bodyPointer, begin, end, grainSize, chunkCount]()
+	{
+		unsigned int chunk;
+		while ((chunk = state->nextChunk.fetch_add(1u)) < chunkCount)
+		{
+			unsigned int chunkBegin = begin + chunk * grainSize;
+			unsigned int chunkEnd = chunkBegin + grainSize < end ? chunkBegin + grainSize : end;
+			(*bodyPointer)(chunkBegin, chunkEnd);
+			state->doneChunks.fetch_add(1u, std::memory_order_release);
+		}
+	};
+
+	unsigned int helperCount = chunkCount - 1u < (unsigned int)workers.size() ? chunkCount - 1u : (unsigned int)workers.size();
+	for (unsigned int i = 0; i < helperCount; i++)
+		submit(runChunks);
+
+	runChunks();
+	while (state->doneChunks.load(std::memory_order_acquire) < chunkCount)
+		std::this_thread::yield();
+}
+
+unsigned int ThreadPool::getWorkerCount() const
+{
+	return (unsigned int)workers.size();
+}
+
+unsigned long long ThreadPool::getStealCount() const
+{
+	return stealCount.load(std::memory_order_relaxed);
+}
+
+unsigned int ThreadPool::getDefaultWorkerCount()
+{
+	unsigned int coreCount = std::thread::hardware_concurrency();
+	return coreCount > 1u ? coreCount - 1u : 1u;
+}
+
+void ThreadPool::workerLoop(unsigned int index)
+{
+	currentPool = this;
+	currentWorkerIndex = index;
+
+	Job job;
+	while (true)
+	{
+		if (popLocal(index, job) || steal(index, job))
+		{
+			job();
+			job = nullptr;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepingWorkers.fetch_add(1u);
+		wakeCondition.wait(lock, [this]() { return pendingJobs.load() > 0u || !running; });
+		sleepingWorkers.fetch_sub(1u);
+
+		//Queued jobs are still run on shutdown, the pool only exits once it is drained.
+		if (!running && pendingJobs.load() == 0u)
+			return;
+	}
+}
+
+bool ThreadPool::popLocal(unsigned int index, Job& job)
+{
+	WorkerQueue& queue = *queues[index];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.jobs.empty())
+		return false;
+
+	job = std::move(queue.jobs.back());
+	queue.jobs.pop_back();
+	pendingJobs.fetch_sub(1u);
+	return true;
+}
+
+bool ThreadPool::steal(unsigned int index, Job& job)
+{
+	unsigned int queueCount = (unsigned int)queues.size();
+	for (unsigned int offset = 1; offset < queueCount; offset++)
+	{
+		WorkerQueue& queue = *queues[(index + offset) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty())
+			continue;
+
+		job = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+		pendingJobs.fetch_sub(1u);
+		stealCount.fetch_add(1u, std::memory_order_relaxed);
+		return true;
+	}
+
+	return false;
+}
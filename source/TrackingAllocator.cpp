@@ -0,0 +1,44 @@
+#include "TrackingAllocator.h"
+
+static constexpr size_t headerSize = 16u;
+
+TrackingAllocator::TrackingAllocator() :
+	liveBytes(0u),
+	peakBytes(0u)
+{
+}
+
+void* TrackingAllocator::allocate(size_t size, const char* typeName, const char* filename, int line)
+{
+	unsigned char* block = static_cast<unsigned char*>(allocator.allocate(size + headerSize, typeName, filename, line));
+	if (!block)
+		return nullptr;
+
+	*reinterpret_cast<size_t*>(block) = size;
+	size_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+	size_t peak = peakBytes.load(std::memory_order_relaxed);
+	while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+	{
+	}
+	return block + headerSize;
+}
+
+void TrackingAllocator::deallocate(void* ptr)
+{
+	if (!ptr)
+		return;
+
+	unsigned char* block = static_cast<unsigned char*>(ptr) - headerSize;
+	liveBytes.fetch_sub(*reinterpret_cast<size_t*>(block), std::memory_order_relaxed);
+	allocator.deallocate(block);
+}
+
+size_t TrackingAllocator::getLiveBytes() const
+{
+	return liveBytes.load(std::memory_order_relaxed);
+}
+
+size_t TrackingAllocator::getPeakBytes() const
+{
+	return peakBytes.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,189 @@
+#include "TransformBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+//Written slots closer than this are uploaded as one range, a few unchanged matrices cost less than another call.
+static constexpr unsigned int mergeGap = 8u;
+
+TransformBuffer::TransformBuffer(unsigned int transformBindingIndex, unsigned int visibleBindingIndex) :
+	transformSSBO(0u),
+	visibleSSBO(0u),
+	transformBinding(transformBindingIndex),
+	visibleBinding(visibleBindingIndex),
+	transformCapacity(0u),
+	visibleCapacity(0u),
+	uploadedBytes(0u)
+{
+	glGenBuffers(1, &transformSSBO);
+	glGenBuffers(1, &visibleSSBO);
+}
+
+unsigned int TransformBuffer::update(TransformCache& cache, BodyMesh mesh, float alpha, ThreadPool& pool, StreamBuffer& stream)
+{
+	unsigned int count = cache.getBodyCount(mesh);
+	transforms.resize(count);
+
+	//Dirty slots are written with their latest pose, a body that fell asleep keeps exactly that transform.
+	writtenSlots.clear();
+	cache.takeDirtySlots(mesh, dirtySlots);
+	for (unsigned int slot : dirtySlots)
+	{
+		//Removals can leave slots past the end of the cache.
+		if (slot >= count)
+			continue;
+		transforms[slot] = cache.getInterpolatedMatrix(mesh, slot, 1.f);
+		writtenSlots.push_back(slot);
+	}
+
+	//Awake bodies are rewritten every frame because their interpolated pose changes with "alpha".
+	const std::vector<unsigned int>& awake = cache.getAwakeSlots(mesh);
+	const unsigned int* awakeSlots = awake.data();
+	glm::mat4* matrices = transforms.data();
+	pool.parallelFor(0u, (unsigned int)awake.size(), 256u, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+			matrices[awakeSlots[i]] = cache.getInterpolatedMatrix(mesh, awakeSlots[i], alpha);
+	});
+	writtenSlots.insert(writtenSlots.end(), awake.begin(), awake.end());
+
+	if (count == 0u || writtenSlots.empty())
+		return (unsigned int)writtenSlots.size();
+
+	uploadRanges.clear();
+	if (count > transformCapacity)
+	{
+		//Grow geometrically. New storage has undefined content, so every slot is uploaded.
+		transformCapacity = count * 2u;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, transformSSBO);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, transformCapacity * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		uploadRanges.push_back({ 0u, count });
+	}
+	else if (writtenSlots.size() * 2u > count)
+	{
+		//Most of the scene is awake, one upload is cheaper than sorting and splitting.
+		uploadRanges.push_back({ 0u, count });
+	}
+	else
+	{
+		std::sort(writtenSlots.begin(), writtenSlots.end());
+		unsigned int first = writtenSlots[0];
+		unsigned int last = first;
+		for (unsigned int slot : writtenSlots)
+		{
+			if (slot > last + mergeGap)
+			{
+				uploadRanges.push_back({ first, last - first + 1u });
+				first = slot;
+			}
+			last = slot;
+		}
+		uploadRanges.push_back({ first, last - first + 1u });
+	}
+	uploadTransforms(stream);
+
+	return (unsigned int)writtenSlots.size();
+}
+
+void TransformBuffer::setVisibleSlots(const std::vector<unsigned int>& slots, StreamBuffer& stream)
+{
+	//An unchanged list keeps the copy already on the GPU, a static camera over a settled scene uploads nothing.
+	if (slots == visible)
+		return;
+
+	visible = slots;
+	if (visible.empty())
+		return;
+
+	size_t bytes = visible.size() * sizeof(unsigned int);
+	uploadedBytes += bytes;
+	if (visible.size() > visibleCapacity)
+	{
+		visibleCapacity = visible.size() * 2u;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleSSBO);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, visibleCapacity * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	//Staged in mapped memory and copied into the persistent buffer on the GPU.
+	StreamAllocation allocation = stream.allocate(bytes, stream.getStorageAlignment());
+	if (allocation.data)
+	{
+		std::memcpy(allocation.data, visible.data(), bytes);
+		glBindBuffer(GL_COPY_READ_BUFFER, stream.getBuffer());
+		glBindBuffer(GL_COPY_WRITE_BUFFER, visibleSSBO);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)allocation.offset, 0, (GLsizeiptr)bytes);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return;
+	}
+
+	//The stream region is full this frame, fall back to a driver copy.
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleSSBO);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, bytes, visible.data());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void TransformBuffer::bind() const
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, transformBinding, transformSSBO);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, visibleBinding, visibleSSBO);
+}
+
+void TransformBuffer::release()
+{
+	if (transformSSBO == 0u)
+		return;
+
+	glDeleteBuffers(1, &transformSSBO);
+	glDeleteBuffers(1, &visibleSSBO);
+	transformSSBO = visibleSSBO = 0u;
+	transformCapacity = visibleCapacity = 0u;
+	visible.clear();
+}
+
+unsigned int TransformBuffer::getVisibleCount() const
+{
+	return (unsigned int)visible.size();
+}
+
+unsigned long long TransformBuffer::getUploadedBytes() const
+{
+	return uploadedBytes;
+}
+
+void TransformBuffer::uploadTransforms(StreamBuffer& stream)
+{
+	unsigned int total = 0u;
+	for (const UploadRange& range : uploadRanges)
+		total += range.count;
+	uploadedBytes += total * sizeof(glm::mat4);
+
+	//Ranges are packed back to back into mapped memory and copied into place on the GPU.
+	StreamAllocation allocation = stream.allocate(total * sizeof(glm::mat4), sizeof(glm::mat4));
+	if (allocation.data)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, stream.getBuffer());
+		glBindBuffer(GL_COPY_WRITE_BUFFER, transformSSBO);
+		unsigned char* destination = static_cast<unsigned char*>(allocation.data);
+		size_t offset = allocation.offset;
+		for (const UploadRange& range : uploadRanges)
+		{
+			size_t bytes = range.count * sizeof(glm::mat4);
+			std::memcpy(destination, transforms.data() + range.first, bytes);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)offset, (GLintptr)(range.first * sizeof(glm::mat4)), (GLsizeiptr)bytes);
+			destination += bytes;
+			offset += bytes;
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return;
+	}
+
+	//The stream region is full this frame, fall back to a driver copy.
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, transformSSBO);
+	for (const UploadRange& range : uploadRanges)
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, range.first * sizeof(glm::mat4), range.count * sizeof(glm::mat4), transforms.data() + range.first);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
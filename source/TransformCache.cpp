@@ -0,0 +1,253 @@
+#include "TransformCache.h"
+
+//userData layout: ((index << meshBits) | mesh) + 1. Zero is reserved for actors without a render slot.
+static constexpr uintptr_t meshBits = 4u;
+static constexpr uintptr_t meshMask = (uintptr_t(1) << meshBits) - 1u;
+
+TransformCache::TransformCache() :
+	lastUpdateCount(0u),
+	latestStep(0u)
+{
+}
+
+void TransformCache::addBody(physx::PxRigidDynamic* actor, BodyMesh mesh, const glm::vec3& scale)
+{
+	unsigned int m = (unsigned int)mesh;
+	actor->userData = encodeSlot(mesh, (unsigned int)actors[m].size());
+	actors[m].push_back(actor);
+	physx::PxTransform pose = actor->getGlobalPose();
+	physx::PxBounds3 bounds = actor->getWorldBounds();
+	poses[m].push_back({ pose, pose, latestStep, bounds, scale, notAwake, false });
+	cullBounds[m].push(bounds);
+
+	unsigned int index = (unsigned int)poses[m].size() - 1u;
+	if (!actor->isSleeping())
+		addAwake(m, index);
+	markDirty(m, index);
+}
+
+bool TransformCache::addBody(physx::PxRigidDynamic* actor)
+{
+	physx::PxShape* shape = nullptr;
+	if (actor->getShapes(&shape, 1u) == 0u)
+		return false;
+
+	physx::PxGeometryHolder geometry(shape->getGeometry());
+	switch (geometry.getType())
+	{
+	case physx::PxGeometryType::eBOX:
+	{
+		const physx::PxVec3& halfExtents = geometry.box().halfExtents;
+		addBody(actor, BodyMesh::Cube, glm::vec3(halfExtents.x, halfExtents.y, halfExtents.z));
+		return true;
+	}
+	case physx::PxGeometryType::eSPHERE:
+		addBody(actor, BodyMesh::Sphere, glm::vec3(geometry.sphere().radius));
+		return true;
+	default:
+		return false;
+	}
+}
+
+void TransformCache::removeBody(physx::PxRigidDynamic* actor)
+{
+	BodyMesh mesh;
+	unsigned int index;
+	if (!decodeSlot(actor->userData, mesh, index))
+		return;
+
+	unsigned int m = (unsigned int)mesh;
+	unsigned int last = (unsigned int)actors[m].size() - 1u;
+	removeAwake(m, index);
+	if (index != last)
+	{
+		actors[m][index] = actors[m][last];
+		poses[m][index] = poses[m][last];
+		actors[m][index]->userData = encodeSlot(mesh, index);
+
+		//The moved body keeps its awake entry, its GPU transform has to be written to the new slot.
+		BodyPose& moved = poses[m][index];
+		if (moved.awakeIndex != notAwake)
+			awakeSlots[m][moved.awakeIndex] = index;
+		moved.dirty = false;
+		markDirty(m, index);
+	}
+	actors[m].pop_back();
+	poses[m].pop_back();
+	cullBounds[m].swapRemove(index);
+
+	actor->userData = nullptr;
+}
+
+unsigned int TransformCache::updateFromActiveActors(physx::PxScene* scene)
+{
+	physx::PxU32 activeCount = 0;
+	physx::PxActor** activeActors = scene->getActiveActors(activeCount);
+
+	latestStep++;
+	lastUpdateCount = 0u;
+	for (physx::PxU32 i = 0; i < activeCount; i++)
+	{
+		BodyMesh mesh;
+		unsigned int index;
+		if (!decodeSlot(activeActors[i]->userData, mesh, index))
+			continue;
+
+		physx::PxRigidActor* actor = static_cast<physx::PxRigidActor*>(activeActors[i]);
+		BodyPose& pose = poses[(unsigned int)mesh][index];
+		//Active actors are awake by definition, this also covers wake ups that were never notified.
+		if (pose.awakeIndex == notAwake)
+			addAwake((unsigned int)mesh, index);
+		pose.previous = pose.current;
+		pose.current = actor->getGlobalPose();
+		pose.movedStep = latestStep;
+
+		physx::PxBounds3 bounds = actor->getWorldBounds();
+		physx::PxBounds3 swept = bounds;
+		swept.include(pose.bounds);
+		pose.bounds = bounds;
+		cullBounds[(unsigned int)mesh].set(index, swept);
+		lastUpdateCount++;
+	}
+
+	return lastUpdateCount;
+}
+
+unsigned int TransformCache::getBodyCount(BodyMesh mesh) const
+{
+	return (unsigned int)actors[(unsigned int)mesh].size();
+}
+
+physx::PxRigidDynamic* TransformCache::getActor(BodyMesh mesh, unsigned int index) const
+{
+	return actors[(unsigned int)mesh][index];
+}
+
+const physx::PxTransform& TransformCache::getPose(BodyMesh mesh, unsigned int index) const
+{
+	return poses[(unsigned int)mesh][index].current;
+}
+
+const physx::PxTransform& TransformCache::getPose(const physx::PxRigidDynamic* actor) const
+{
+	BodyMesh mesh = BodyMesh::Cube;
+	unsigned int index = 0u;
+	decodeSlot(actor->userData, mesh, index);
+	return poses[(unsigned int)mesh][index].current;
+}
+
+glm::mat4 TransformCache::getInterpolatedMatrix(BodyMesh mesh, unsigned int index, float alpha) const
+{
+	const BodyPose& pose = poses[(unsigned int)mesh][index];
+	const physx::PxTransform& c = pose.current;
+
+	glm::vec3 position(c.p.x, c.p.y, c.p.z);
+	glm::quat rotation(c.q.w, c.q.x, c.q.y, c.q.z);
+	if (pose.movedStep == latestStep)
+	{
+		const physx::PxTransform& p = pose.previous;
+		position = glm::mix(glm::vec3(p.p.x, p.p.y, p.p.z), position, alpha);
+		rotation = glm::slerp(glm::quat(p.q.w, p.q.x, p.q.y, p.q.z), rotation, alpha);
+	}
+
+	glm::mat4 model = glm::mat4_cast(rotation);
+	model[0] *= pose.scale.x;
+	model[1] *= pose.scale.y;
+	model[2] *= pose.scale.z;
+	model[3] = glm::vec4(position, 1.f);
+	return model;
+}
+
+void TransformCache::applySleepTransitions(CollisionCallback& callback)
+{
+	callback.takeSleepTransitions(transitionScratch);
+	for (const SleepTransition& transition : transitionScratch)
+	{
+		BodyMesh mesh;
+		unsigned int index;
+		if (!decodeSlot(transition.actor->userData, mesh, index))
+			continue;
+
+		if (transition.sleeping)
+		{
+			removeAwake((unsigned int)mesh, index);
+			markDirty((unsigned int)mesh, index);
+		}
+		else if (poses[(unsigned int)mesh][index].awakeIndex == notAwake)
+		{
+			addAwake((unsigned int)mesh, index);
+		}
+	}
+}
+
+const BoundsSoA& TransformCache::getCullBounds(BodyMesh mesh) const
+{
+	return cullBounds[(unsigned int)mesh];
+}
+
+unsigned int TransformCache::getLastUpdateCount() const
+{
+	return lastUpdateCount;
+}
+
+const std::vector<unsigned int>& TransformCache::getAwakeSlots(BodyMesh mesh) const
+{
+	return awakeSlots[(unsigned int)mesh];
+}
+
+void TransformCache::takeDirtySlots(BodyMesh mesh, std::vector<unsigned int>& slots)
+{
+	unsigned int m = (unsigned int)mesh;
+	slots.clear();
+	slots.swap(dirtySlots[m]);
+	for (unsigned int slot : slots)
+	{
+		if (slot < poses[m].size())
+			poses[m][slot].dirty = false;
+	}
+}
+
+void* TransformCache::encodeSlot(BodyMesh mesh, unsigned int index)
+{
+	return reinterpret_cast<void*>((((uintptr_t)index << meshBits) | (uintptr_t)mesh) + 1u);
+}
+
+bool TransformCache::decodeSlot(const void* userData, BodyMesh& mesh, unsigned int& index)
+{
+	uintptr_t value = reinterpret_cast<uintptr_t>(userData);
+	if (value == 0u)
+		return false;
+
+	value -= 1u;
+	mesh = (BodyMesh)(value & meshMask);
+	index = (unsigned int)(value >> meshBits);
+	return true;
+}
+
+void TransformCache::addAwake(unsigned int mesh, unsigned int index)
+{
+	poses[mesh][index].awakeIndex = (unsigned int)awakeSlots[mesh].size();
+	awakeSlots[mesh].push_back(index);
+}
+
+void TransformCache::removeAwake(unsigned int mesh, unsigned int index)
+{
+	unsigned int awakeIndex = poses[mesh][index].awakeIndex;
+	if (awakeIndex == notAwake)
+		return;
+
+	unsigned int lastSlot = awakeSlots[mesh].back();
+	awakeSlots[mesh][awakeIndex] = lastSlot;
+	poses[mesh][lastSlot].awakeIndex = awakeIndex;
+	awakeSlots[mesh].pop_back();
+	poses[mesh][index].awakeIndex = notAwake;
+}
+
+void TransformCache::markDirty(unsigned int mesh, unsigned int index)
+{
+	if (poses[mesh][index].dirty)
+		return;
+
+	poses[mesh][index].dirty = true;
+	dirtySlots[mesh].push_back(index);
+}
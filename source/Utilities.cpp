@@ -1,12 +1,15 @@
 #include "Utilities.h"
 
+#include "TextureCache.h"
+
 //Accelerating interpolation function.
 float alip(float a, float b, float f)
 {
     return a + f * (b - a);
 }
 
-void renderCube()
+//Lazily creates the unit cube VAO shared by renderCube() and renderCubeInstanced().
+static unsigned int getCubeVAO()
 {
     // initialize (if necessary)
     static unsigned int cubeVAO, cubeVBO;
@@ -72,12 +75,27 @@ void renderCube()
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
     }
+    return cubeVAO;
+}
+
+void renderCube()
+{
     // render Cube
-    glBindVertexArray(cubeVAO);
+    glBindVertexArray(getCubeVAO());
     glDrawArrays(GL_TRIANGLES, 0, 36);
     glBindVertexArray(0);
 }
 
+// renderCubeInstanced() draws "instanceCount" cubes, transforms are read from the bound instance buffer.
+// -----------------------------------------
+
+void renderCubeInstanced(unsigned int instanceCount)
+{
+    glBindVertexArray(getCubeVAO());
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, instanceCount);
+    glBindVertexArray(0);
+}
+
 
 // renderQuad() renders a 1x1 XY quad in NDC
 // -----------------------------------------
@@ -114,51 +132,61 @@ void renderQuad()
 
 unsigned int loadTextureFromFile(const char* path)
 {
-    GLuint textureId;
-    glGenTextures(1, &textureId);
+    unsigned int textureId = TextureCache::instance().acquire(path, false, GL_CLAMP_TO_EDGE);
+    if (textureId == 0)
+    {
+        glfwTerminate();
+        std::exit(EXIT_FAILURE);
+    }
 
+    return textureId;
+}
+
+unsigned int uploadTextureFromFile(const char* path, bool gamma, GLint wrapMode)
+{
     int width, height, numberOfChannels;
     unsigned char* data = stbi_load(path, &width, &height, &numberOfChannels, 0);
-    if (data)
+    if (!data)
     {
-        GLenum textureFormat = GL_INVALID_ENUM;
-        if (numberOfChannels == 1)
-        {
-            textureFormat = GL_RED;
-        }
-        else if (numberOfChannels == 3)
-        {
-            textureFormat = GL_RGB;
-        }
-        else if (numberOfChannels == 4)
-        {
-            textureFormat = GL_RGBA;
-        }
-        else
-        {
-            printf("ERROR: Invalid texture format. \n");
-            glfwTerminate();
-            std::exit(EXIT_FAILURE);
-        }
-
-        glBindTexture(GL_TEXTURE_2D, textureId);
-        glTexImage2D(GL_TEXTURE_2D, 0, textureFormat, width, height, 0, textureFormat, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        printf("ERROR: Texture could not load from: %s\n", path);
+        return 0;
+    }
 
-        stbi_image_free(data);
+    GLenum textureFormat = GL_INVALID_ENUM;
+    GLenum internalFormat = GL_INVALID_ENUM;
+    if (numberOfChannels == 1)
+    {
+        textureFormat = GL_RED;
+        internalFormat = GL_R8;
+    }
+    else if (numberOfChannels == 3)
+    {
+        textureFormat = GL_RGB;
+        internalFormat = gamma ? GL_SRGB8 : GL_RGB8;
+    }
+    else if (numberOfChannels == 4)
+    {
+        textureFormat = GL_RGBA;
+        internalFormat = gamma ? GL_SRGB8_ALPHA8 : GL_RGBA8;
     }
     else
     {
-        printf("ERROR: Texture could not load from: %s ", path);
+        printf("ERROR: Invalid texture format in: %s\n", path);
         stbi_image_free(data);
-        glfwTerminate();
-        std::exit(EXIT_FAILURE);
+        return 0;
     }
 
+    GLuint textureId;
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, textureFormat, GL_UNSIGNED_BYTE, data);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    stbi_image_free(data);
     return textureId;
 }